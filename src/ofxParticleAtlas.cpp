@@ -0,0 +1,269 @@
+//
+// ofxParticleAtlas.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticleAtlas.h"
+
+// ------------------------------------------------------------------------
+// ofxParticleAtlasPacker
+// ------------------------------------------------------------------------
+
+ofxParticleAtlasPacker::ofxParticleAtlasPacker( int pageSize /* = 1024 */, int padding /* = 1 */ )
+{
+	this->pageSize = pageSize;
+	this->padding = padding;
+	numPages = 0;
+}
+
+int ofxParticleAtlasPacker::add( int width, int height )
+{
+	Rect rect;
+	rect.width = width;
+	rect.height = height;
+	rect.page = -1;
+	rect.x = rect.y = 0;
+	
+	rects.push_back( rect );
+	return rects.size() - 1;
+}
+
+void ofxParticleAtlasPacker::clear()
+{
+	rects.clear();
+	numPages = 0;
+}
+
+// Tallest first so shelves waste as little height as possible, ties are broken by
+// the order the rectangles were added to keep the packing deterministic
+struct ofxParticleAtlasPackerOrder
+{
+	const std::vector<int>* widths;
+	const std::vector<int>* heights;
+	
+	bool operator()( int a, int b ) const
+	{
+		if ( (*heights)[a] != (*heights)[b] ) return (*heights)[a] > (*heights)[b];
+		if ( (*widths)[a] != (*widths)[b] ) return (*widths)[a] > (*widths)[b];
+		return a < b;
+	}
+};
+
+bool ofxParticleAtlasPacker::pack()
+{
+	std::vector<int> order( rects.size() ), widths( rects.size() ), heights( rects.size() );
+	for ( unsigned int i = 0; i < rects.size(); i++ )
+	{
+		order[i] = i;
+		widths[i] = rects[i].width + padding * 2;
+		heights[i] = rects[i].height + padding * 2;
+	}
+	
+	ofxParticleAtlasPackerOrder compare;
+	compare.widths = &widths;
+	compare.heights = &heights;
+	std::sort( order.begin(), order.end(), compare );
+	
+	std::vector<Page> pages;
+	bool ok = true;
+	
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		Rect& rect = rects[order[i]];
+		int w = widths[order[i]];
+		int h = heights[order[i]];
+		
+		rect.page = -1;
+		if ( w > pageSize || h > pageSize )
+		{
+			ofLog( OF_LOG_ERROR, "ofxParticleAtlasPacker::pack() - rectangle larger than a page!" );
+			ok = false;
+			continue;
+		}
+		
+		// Try the current shelf of every page, then a new shelf, then a new page
+		for ( unsigned int p = 0; p <= pages.size() && rect.page == -1; p++ )
+		{
+			if ( p == pages.size() )
+			{
+				Page page = { 0, 0, 0 };
+				pages.push_back( page );
+			}
+			
+			Page& page = pages[p];
+			if ( page.cursorX + w > pageSize || h > page.shelfHeight )
+			{
+				// The current shelf is full or too short, open a new one below it
+				if ( page.shelfY + page.shelfHeight + h > pageSize )
+					continue;
+				
+				if ( page.cursorX + w > pageSize || page.shelfHeight > 0 )
+				{
+					page.shelfY += page.shelfHeight;
+					page.cursorX = 0;
+				}
+				page.shelfHeight = h;
+			}
+			
+			rect.page = p;
+			rect.x = page.cursorX + padding;
+			rect.y = page.shelfY + padding;
+			page.cursorX += w;
+		}
+	}
+	
+	numPages = pages.size();
+	return ok;
+}
+
+void ofxParticleAtlasPacker::getPixelRect( int id, int& page, int& x, int& y ) const
+{
+	page = rects[id].page;
+	x = rects[id].x;
+	y = rects[id].y;
+}
+
+AtlasRegion ofxParticleAtlasPacker::getRegion( int id ) const
+{
+	const Rect& rect = rects[id];
+	
+	AtlasRegion region;
+	region.page = rect.page;
+	region.u1 = (GLfloat)rect.x / pageSize;
+	region.v1 = (GLfloat)rect.y / pageSize;
+	region.u2 = (GLfloat)( rect.x + rect.width ) / pageSize;
+	region.v2 = (GLfloat)( rect.y + rect.height ) / pageSize;
+	return region;
+}
+
+// ------------------------------------------------------------------------
+// ofxParticleAtlas
+// ------------------------------------------------------------------------
+
+ofxParticleAtlas::ofxParticleAtlas( int pageSize /* = 1024 */, int padding /* = 1 */ )
+{
+	this->pageSize = pageSize;
+	this->padding = padding;
+}
+
+ofxParticleAtlas::~ofxParticleAtlas()
+{
+	exit();
+}
+
+void ofxParticleAtlas::exit()
+{
+	for ( unsigned int i = 0; i < pages.size(); i++ )
+		delete pages[i];
+	pages.clear();
+}
+
+bool ofxParticleAtlas::build( const std::vector<ofxParticleEmitter*>& emitters )
+{
+	exit();
+	
+	ofxParticleAtlasPacker packer( pageSize, padding );
+	
+	// One rectangle per distinct image file, in the order the emitters were given
+	std::vector<ofImage*> images;
+	std::map<std::string, int> imageIds;
+	std::vector<int> emitterIds( emitters.size(), -1 );
+	
+	for ( unsigned int i = 0; i < emitters.size(); i++ )
+	{
+		ofImage* image = emitters[i]->getTexture();
+		if ( image == NULL ) continue;
+		
+		const std::string& filename = emitters[i]->getTextureFilename();
+		std::map<std::string, int>::iterator it = imageIds.find( filename );
+		if ( it == imageIds.end() )
+		{
+			int id = packer.add( image->width, image->height );
+			imageIds[filename] = id;
+			images.push_back( image );
+			emitterIds[i] = id;
+		}
+		else
+		{
+			emitterIds[i] = it->second;
+		}
+	}
+	
+	bool ok = packer.pack();
+	
+	// Composite the images into RGBA pages and upload them
+	int pageBytes = pageSize * pageSize * 4;
+	for ( int p = 0; p < packer.getNumPages(); p++ )
+	{
+		unsigned char* pixels = (unsigned char*)calloc( pageBytes, 1 );
+		assert( pixels );
+		
+		for ( unsigned int id = 0; id < images.size(); id++ )
+		{
+			int page, x, y;
+			packer.getPixelRect( id, page, x, y );
+			if ( page == p )
+				copyPixels( images[id], pixels, x, y );
+		}
+		
+		ofTexture* texture = new ofTexture();
+		texture->allocate( pageSize, pageSize, GL_RGBA );
+		texture->loadData( pixels, pageSize, pageSize, GL_RGBA );
+		pages.push_back( texture );
+		
+		free( pixels );
+	}
+	
+	for ( unsigned int i = 0; i < emitters.size(); i++ )
+	{
+		if ( emitterIds[i] != -1 )
+			emitters[i]->setAtlasRegion( packer.getRegion( emitterIds[i] ) );
+	}
+	
+	return ok;
+}
+
+void ofxParticleAtlas::copyPixels( ofImage* image, unsigned char* page, int x, int y )
+{
+	unsigned char* src = image->getPixels();
+	int channels = image->bpp / 8;
+	
+	for ( int row = 0; row < image->height; row++ )
+	{
+		unsigned char* s = src + row * image->width * channels;
+		unsigned char* d = page + ( ( y + row ) * pageSize + x ) * 4;
+		
+		for ( int col = 0; col < image->width; col++, s += channels, d += 4 )
+		{
+			if ( channels >= 3 )
+			{
+				d[0] = s[0];
+				d[1] = s[1];
+				d[2] = s[2];
+			}
+			else
+			{
+				d[0] = d[1] = d[2] = s[0];
+			}
+			d[3] = ( channels == 4 ) ? s[3] : 255;
+		}
+	}
+}
@@ -0,0 +1,101 @@
+//
+// ofxParticleAtlas.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_ATLAS
+#define _OFX_PARTICLE_ATLAS
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+
+// ------------------------------------------------------------------------
+// ofxParticleAtlasPacker
+// ------------------------------------------------------------------------
+
+// Packs rectangles into square pages using shelves.  It only does the math so it
+// can be used without a GL context, and the result only depends on the order and
+// sizes of the rectangles added.
+class ofxParticleAtlasPacker
+{
+	
+public:
+	
+	ofxParticleAtlasPacker( int pageSize = 1024, int padding = 1 );
+	
+	int		add( int width, int height );	// Returns the id of the rectangle
+	bool	pack();							// False if a rectangle is bigger than a page
+	void	clear();
+	
+	int		getNumPages() const { return numPages; }
+	int		getPageSize() const { return pageSize; }
+	
+	// Placement of a packed rectangle, in pixels and in normalized coordinates
+	void		getPixelRect( int id, int& page, int& x, int& y ) const;
+	AtlasRegion	getRegion( int id ) const;
+	
+protected:
+	
+	typedef struct
+	{
+		int		width, height;
+		int		page, x, y;
+	} Rect;
+	
+	typedef struct
+	{
+		int		shelfY, shelfHeight, cursorX;
+	} Page;
+	
+	std::vector<Rect>	rects;
+	int					pageSize, padding, numPages;
+};
+
+// ------------------------------------------------------------------------
+// ofxParticleAtlas
+// ------------------------------------------------------------------------
+
+// Builds atlas pages out of the textures of a set of emitters and gives every
+// emitter its region.  Emitters using the same image file share a region.
+class ofxParticleAtlas
+{
+	
+public:
+	
+	ofxParticleAtlas( int pageSize = 1024, int padding = 1 );
+	~ofxParticleAtlas();
+	
+	// The emitters must be loaded, their image pixels are copied into the pages
+	bool		build( const std::vector<ofxParticleEmitter*>& emitters );
+	void		exit();
+	
+	int			getNumPages() const { return pages.size(); }
+	ofTexture*	getPage( int page ) { return pages[page]; }
+	
+protected:
+	
+	void		copyPixels( ofImage* image, unsigned char* page, int x, int y );
+	
+	std::vector<ofTexture*>	pages;
+	int						pageSize, padding;
+};
+
+#endif
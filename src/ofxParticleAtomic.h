@@ -0,0 +1,74 @@
+//
+// ofxParticleAtomic.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_ATOMIC
+#define _OFX_PARTICLE_ATOMIC
+
+#include "ofMain.h"
+
+// ------------------------------------------------------------------------
+// Atomic operations
+// ------------------------------------------------------------------------
+
+// Minimal atomic operations on ints for handing data between the simulation and
+// other threads without locks.  They are all full memory barriers.
+
+#ifdef TARGET_WIN32
+
+static inline int ofxParticleAtomicLoad( volatile int* target ) {
+	return InterlockedCompareExchange( (volatile LONG*)target, 0, 0 );
+}
+
+static inline void ofxParticleAtomicStore( volatile int* target, int value ) {
+	InterlockedExchange( (volatile LONG*)target, value );
+}
+
+// Return the previous value of target
+static inline int ofxParticleAtomicExchange( volatile int* target, int value ) {
+	return InterlockedExchange( (volatile LONG*)target, value );
+}
+
+#else
+
+static inline int ofxParticleAtomicLoad( volatile int* target ) {
+	return __sync_fetch_and_add( target, 0 );
+}
+
+static inline void ofxParticleAtomicStore( volatile int* target, int value ) {
+	__sync_synchronize();
+	*target = value;
+	__sync_synchronize();
+}
+
+// Return the previous value of target
+static inline int ofxParticleAtomicExchange( volatile int* target, int value ) {
+	int previous;
+	do {
+		previous = *target;
+	} while ( !__sync_bool_compare_and_swap( target, previous, value ) );
+	return previous;
+}
+
+#endif
+
+#endif
@@ -22,6 +22,11 @@
 // THE SOFTWARE.
 
 #include "ofxParticleEmitter.h"
+#include "ofxParticleEmitterShape.h"
+#include "ofxParticleTransform.h"
+
+#include <cstddef>
+#include <fstream>
 
 // ------------------------------------------------------------------------
 // Lifecycle
@@ -33,6 +38,11 @@ ofxParticleEmitter::ofxParticleEmitter()
 	
 	emitterType = kParticleTypeGravity;
 	texture = NULL;
+	atlasRegion.page = -1;
+	atlasRegion.u1 = atlasRegion.v1 = 0.0f;
+	atlasRegion.u2 = atlasRegion.v2 = 1.0f;
+	shape = new ofxParticleEmitterShape();
+	transform = NULL;
 	sourcePosition.x = sourcePosition.y = 0.0f;
 	sourcePositionVariance.x = sourcePositionVariance.y = 0.0f;
 	angle = angleVariance = 0.0f;								
@@ -54,99 +64,291 @@ ofxParticleEmitter::ofxParticleEmitter()
 	elapsedTime = 0.0f;
 	duration = -1;
 	lastUpdateMillis = 0;
+	
+	// Seed from ofRandom so ofSeedRandom() still controls the emitters
+	setRandomSeed( (GLuint)ofRandom( 1.0f, 16777216.0f ) );
     
 	blendFuncSource = blendFuncDestination = 0;
+	sortMode = kParticleSortNone;
+	layer = 0;
+	simulationSpace = kParticleSpaceWorld;
 
 	maxRadius = maxRadiusVariance = radiusSpeed = minRadius = 0.0f;
 	rotatePerSecond = rotatePerSecondVariance = 0.0f;
 	
-	active = useTexture = false;
+	active = useTexture = loaded = false;
+	emitting = ownsTexture = true;
+	bursting = textureChanged = false;
 	particleIndex = 0;
 
 	verticesID = 0;
 	particles = NULL;
 	vertices = NULL;
+	
+	sortScratch = NULL;
+	sortKeys = NULL;
+	sortCapacity = 0;
+	
+	for ( int i = 0; i < kParticleEventCount; i++ )
+	{
+		events[i] = NULL;
+		numEvents[i] = 0;
+		numDroppedEvents[i] = 0;
+	}
+	eventCapacity = 0;
+	eventUsers = 0;
 }
 
 ofxParticleEmitter::~ofxParticleEmitter()
 {
 	exit();
+	
+	delete shape;
 }
 
 void ofxParticleEmitter::exit()
 {	
-	if ( texture != NULL )
+	if ( texture != NULL && ownsTexture )
 		delete texture;
 	texture = NULL;
+	textureFilename = "";
+	ownsTexture = true;
+	atlasRegion.page = -1;
+	*shape = ofxParticleEmitterShape();
 	
 	if ( particles != NULL )
-		delete particles;
+		free( particles );
 	particles = NULL;
 	
 	if ( vertices != NULL )
-		delete vertices;
+		free( vertices );
 	vertices = NULL;
 	
-	glDeleteBuffers( 1, &verticesID );
+	if ( sortScratch != NULL )
+		free( sortScratch );
+	sortScratch = NULL;
+	
+	if ( sortKeys != NULL )
+		free( sortKeys );
+	sortKeys = NULL;
+	sortCapacity = 0;
+	
+	setEventCapacity( 0 );
+	
+	if ( verticesID != 0 )
+		glDeleteBuffers( 1, &verticesID );
+	verticesID = 0;
+	
+	particleCount = 0;
+	active = loaded = false;
 }
 
 bool ofxParticleEmitter::loadFromXml( const std::string& filename )
 {
-	bool ok = false;
+	if ( !loadConfig( filename ) )
+		return false;
+	
+	finishLoading();
+	
+	return true;
+}
+
+bool ofxParticleEmitter::loadConfig( const std::string& filename )
+{
+	settings = new ofxXmlSettings();
+	
+	return loadSettings( settings->loadFile( filename ) );
+}
+
+bool ofxParticleEmitter::loadConfigFromString( const std::string& xml )
+{
+	settings = new ofxXmlSettings();
+	
+	return loadSettings( settings->loadFromBuffer( xml ) );
+}
+
+// Parse the settings loaded by loadConfig() or loadConfigFromString() and free them
+bool ofxParticleEmitter::loadSettings( bool ok )
+{
+	if ( ok )
+		ok = parseParticleConfig();
+	if ( ok )
+		setupArrays();
+	
+	delete settings;
+	settings = NULL;
+	
+	return ok;
+}
+
+bool ofxParticleEmitter::reloadFromXml( const std::string& filename )
+{
+	if ( !loaded )
+		return loadFromXml( filename );
 	
 	settings = new ofxXmlSettings();
 	
-	ok = settings->loadFile( filename );
+	bool ok = settings->loadFile( filename );
 	if ( ok )
 	{
-		parseParticleConfig();
-		setupArrays();
+		GLint oldMaxParticles = maxParticles;
+		Vector2f oldSourcePosition = sourcePosition;
+		
+		ok = parseParticleConfig();
 		
-		ok = active = true;
+		sourcePosition = oldSourcePosition;
+		
+		// Not a pointer comparison, the new image is often allocated where the old one was
+		if ( texture != NULL && textureChanged )
+			uploadTexture();
+		
+		if ( maxParticles != oldMaxParticles )
+			resizeArrays( maxParticles );
 	}
-
+	
 	delete settings;
 	settings = NULL;
 	
 	return ok;
 }
 
-void ofxParticleEmitter::parseParticleConfig()
+void ofxParticleEmitter::copyConfig( const ofxParticleEmitter& source )
+{
+	if ( texture != NULL && ownsTexture )
+		delete texture;
+	texture = source.texture;
+	textureFilename = source.textureFilename;
+	textureData = source.textureData;
+	atlasRegion = source.atlasRegion;
+	ownsTexture = false;
+	*shape = *source.shape;
+	
+	emitterType = source.emitterType;
+	sourcePosition = source.sourcePosition;
+	sourcePositionVariance = source.sourcePositionVariance;
+	angle = source.angle;
+	angleVariance = source.angleVariance;
+	speed = source.speed;
+	speedVariance = source.speedVariance;
+	radialAcceleration = source.radialAcceleration;
+	tangentialAcceleration = source.tangentialAcceleration;
+	radialAccelVariance = source.radialAccelVariance;
+	tangentialAccelVariance = source.tangentialAccelVariance;
+	gravity = source.gravity;
+	particleLifespan = source.particleLifespan;
+	particleLifespanVariance = source.particleLifespanVariance;
+	startColor = source.startColor;
+	startColorVariance = source.startColorVariance;
+	finishColor = source.finishColor;
+	finishColorVariance = source.finishColorVariance;
+	startParticleSize = source.startParticleSize;
+	startParticleSizeVariance = source.startParticleSizeVariance;
+	finishParticleSize = source.finishParticleSize;
+	finishParticleSizeVariance = source.finishParticleSizeVariance;
+	duration = source.duration;
+	blendFuncSource = source.blendFuncSource;
+	blendFuncDestination = source.blendFuncDestination;
+	sortMode = source.sortMode;
+	layer = source.layer;
+	simulationSpace = source.simulationSpace;
+	maxRadius = source.maxRadius;
+	maxRadiusVariance = source.maxRadiusVariance;
+	radiusSpeed = source.radiusSpeed;
+	minRadius = source.minRadius;
+	rotatePerSecond = source.rotatePerSecond;
+	rotatePerSecondVariance = source.rotatePerSecondVariance;
+	
+	if ( particles == NULL )
+	{
+		maxParticles = source.maxParticles;
+		setupArrays();
+	}
+	else if ( maxParticles != source.maxParticles )
+	{
+		resizeArrays( source.maxParticles );
+	}
+	
+	if ( verticesID == 0 )
+		glGenBuffers( 1, &verticesID );
+	
+	// Start timing from now, otherwise the first update would see the whole time since launch
+	lastUpdateMillis = ofGetElapsedTimeMillis();
+	
+	loaded = active = true;
+}
+
+void ofxParticleEmitter::finishLoading()
+{
+	if ( texture != NULL )
+		uploadTexture();
+	
+	// Generate the vertices VBO
+	glGenBuffers( 1, &verticesID );
+	
+	// Start timing from now, otherwise the first update would see the whole time since launch
+	lastUpdateMillis = ofGetElapsedTimeMillis();
+	
+	loaded = active = true;
+}
+
+bool ofxParticleEmitter::parseParticleConfig()
 {
 	if ( settings == NULL )
 	{
 		ofLog( OF_LOG_ERROR, "ofxParticleEmitter::parseParticleConfig() - XML settings is invalid!" );
-		return;
+		return false;
 	}
 	
-	settings->pushTag( "particleEmitterConfig" );
+	if ( !settings->pushTag( "particleEmitterConfig" ) )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitter::parseParticleConfig() - particleEmitterConfig tag not found!" );
+		return false;
+	}
 
 	std::string imageFilename	= settings->getAttribute( "texture", "name", "" );
 	std::string imageData		= settings->getAttribute( "texture", "data", "" );
 	
+	textureChanged = false;
 	if ( imageFilename != "" )
 	{
-		ofLog( OF_LOG_WARNING, "ofxParticleEmitter::parseParticleConfig() - loading image file" );
-		
-		texture = new ofImage();
-		texture->loadImage( imageFilename );
-		texture->setUseTexture( true );
-		texture->setAnchorPercent( 0.5f, 0.5f );
-		
-		textureData = texture->getTextureReference().getTextureData();
+		// Keep the current texture when reloading a config that still uses the same image
+		if ( texture == NULL || imageFilename != textureFilename )
+		{
+			ofLog( OF_LOG_WARNING, "ofxParticleEmitter::parseParticleConfig() - loading image file" );
+			
+			if ( texture != NULL && ownsTexture )
+				delete texture;
+			textureFilename = imageFilename;
+			ownsTexture = true;
+			
+			// Any atlas placement was for the old image, the atlas has to be rebuilt
+			atlasRegion.page = -1;
+			
+			// Only decode the pixels here, the texture is created by uploadTexture() once
+			// we are back on the GL thread
+			texture = new ofImage();
+			texture->setUseTexture( false );
+			texture->loadImage( imageFilename );
+			textureChanged = true;
+		}
 	}
 	else if ( imageData != "" )
 	{
 		// TODO
 		
 		ofLog( OF_LOG_ERROR, "ofxParticleEmitter::parseParticleConfig() - image data found but not yet implemented!" );
-		return;
+		settings->popTag();
+		return false;
 	}
 
     emitterType					= settings->getAttribute( "emitterType", "value", emitterType );
 	
 	sourcePosition.x			= settings->getAttribute( "sourcePosition", "x", sourcePosition.x );
 	sourcePosition.y			= settings->getAttribute( "sourcePosition", "y", sourcePosition.y );
+	sourcePositionVariance.x	= settings->getAttribute( "sourcePositionVariance", "x", sourcePositionVariance.x );
+	sourcePositionVariance.y	= settings->getAttribute( "sourcePositionVariance", "y", sourcePositionVariance.y );
+	
+	shape->parse( settings );
 	
 	speed						= settings->getAttribute( "speed", "value", speed );
 	speedVariance				= settings->getAttribute( "speedVariance", "value", speedVariance );
@@ -189,6 +391,9 @@ void ofxParticleEmitter::parseParticleConfig()
 	duration					= settings->getAttribute( "duration", "value", duration );
 	blendFuncSource				= settings->getAttribute( "blendFuncSource", "value", blendFuncSource );
 	blendFuncDestination		= settings->getAttribute( "blendFuncDestination", "value", blendFuncDestination );
+	sortMode					= settings->getAttribute( "sortMode", "value", sortMode );
+	layer						= settings->getAttribute( "layer", "value", layer );
+	simulationSpace				= settings->getAttribute( "simulationSpace", "value", simulationSpace );
 	
 	maxRadius					= settings->getAttribute( "maxRadius", "value", maxRadius );
 	maxRadiusVariance			= settings->getAttribute( "maxRadiusVariance", "value", maxRadiusVariance );
@@ -197,6 +402,92 @@ void ofxParticleEmitter::parseParticleConfig()
 	
 	rotatePerSecond				= settings->getAttribute( "rotatePerSecond", "value", rotatePerSecond );
 	rotatePerSecondVariance		= settings->getAttribute( "rotatePerSecondVariance", "value", rotatePerSecondVariance );
+	
+	settings->popTag();
+	
+	validateConfig();
+	return true;
+}
+
+// True unless value is NaN or infinite
+static inline bool isFinite( GLfloat value )
+{
+	return value == value && value - value == 0.0f;
+}
+
+// True if value is one of the blend factors glBlendFunc() accepts
+static inline bool isBlendFactor( int value )
+{
+	return value == GL_ZERO || value == GL_ONE || ( value >= GL_SRC_COLOR && value <= GL_SRC_ALPHA_SATURATE );
+}
+
+// Clamp whatever a config could set to values the simulation can't blow up on.  Done once
+// at load time so update() never has to check
+void ofxParticleEmitter::validateConfig()
+{
+	GLfloat* values[] =
+	{
+		&sourcePosition.x, &sourcePosition.y, &sourcePositionVariance.x, &sourcePositionVariance.y,
+		&angle, &angleVariance, &speed, &speedVariance,
+		&radialAcceleration, &tangentialAcceleration, &radialAccelVariance, &tangentialAccelVariance,
+		&gravity.x, &gravity.y, &particleLifespan, &particleLifespanVariance,
+		&startColor.red, &startColor.green, &startColor.blue, &startColor.alpha,
+		&startColorVariance.red, &startColorVariance.green, &startColorVariance.blue, &startColorVariance.alpha,
+		&finishColor.red, &finishColor.green, &finishColor.blue, &finishColor.alpha,
+		&finishColorVariance.red, &finishColorVariance.green, &finishColorVariance.blue, &finishColorVariance.alpha,
+		&startParticleSize, &startParticleSizeVariance, &finishParticleSize, &finishParticleSizeVariance,
+		&duration, &maxRadius, &maxRadiusVariance, &radiusSpeed, &minRadius,
+		&rotatePerSecond, &rotatePerSecondVariance
+	};
+	
+	for ( unsigned int i = 0; i < sizeof( values ) / sizeof( values[0] ); i++ )
+	{
+		if ( !isFinite( *values[i] ) )
+		{
+			ofLog( OF_LOG_WARNING, "ofxParticleEmitter::validateConfig() - NaN or infinite value replaced with 0!" );
+			*values[i] = 0.0f;
+		}
+		else if ( fabsf( *values[i] ) > MAXIMUM_CONFIG_VALUE && values[i] != &duration )
+		{
+			// Finite but huge values, e.g. a gravity of 1e38, still overflow within a few frames
+			ofLog( OF_LOG_WARNING, "ofxParticleEmitter::validateConfig() - value out of range, clamped!" );
+			*values[i] = ClampFinite( *values[i], MAXIMUM_CONFIG_VALUE );
+		}
+	}
+	
+	if ( maxParticles < 1 || maxParticles > MAXIMUM_PARTICLES )
+	{
+		ofLog( OF_LOG_WARNING, "ofxParticleEmitter::validateConfig() - maxParticles out of range, clamped!" );
+		maxParticles = MAX( 1, MIN( maxParticles, MAXIMUM_PARTICLES ) );
+	}
+	
+	if ( particleLifespan < MINIMUM_LIFESPAN )
+	{
+		ofLog( OF_LOG_WARNING, "ofxParticleEmitter::validateConfig() - particleLifespan too short, clamped!" );
+		particleLifespan = MINIMUM_LIFESPAN;
+	}
+	
+	if ( duration < 0.0f && duration != -1.0f )
+		duration = -1.0f;
+	
+	if ( emitterType != kParticleTypeGravity && emitterType != kParticleTypeRadial )
+	{
+		ofLog( OF_LOG_WARNING, "ofxParticleEmitter::validateConfig() - unknown emitterType, using gravity!" );
+		emitterType = kParticleTypeGravity;
+	}
+	
+	if ( !isBlendFactor( blendFuncSource ) || !isBlendFactor( blendFuncDestination ) )
+	{
+		ofLog( OF_LOG_WARNING, "ofxParticleEmitter::validateConfig() - invalid blend function, using alpha blending!" );
+		blendFuncSource = GL_SRC_ALPHA;
+		blendFuncDestination = GL_ONE_MINUS_SRC_ALPHA;
+	}
+	
+	if ( sortMode < kParticleSortNone || sortMode > kParticleSortAge )
+		sortMode = kParticleSortNone;
+	
+	if ( simulationSpace != kParticleSpaceWorld && simulationSpace != kParticleSpaceLocal )
+		simulationSpace = kParticleSpaceWorld;
 }
 
 void ofxParticleEmitter::setupArrays()
@@ -208,9 +499,6 @@ void ofxParticleEmitter::setupArrays()
 	// If one of the arrays cannot be allocated throw an assertion as this is bad
 	assert( particles && vertices );
 	
-	// Generate the vertices VBO
-	glGenBuffers( 1, &verticesID );
-	
 	// Set the particle count to zero
 	particleCount = 0;
 	
@@ -218,11 +506,59 @@ void ofxParticleEmitter::setupArrays()
 	elapsedTime = 0;
 }
 
+void ofxParticleEmitter::uploadTexture()
+{
+	int glType = GL_RGBA;
+	if ( texture->type == OF_IMAGE_COLOR )
+		glType = GL_RGB;
+	else if ( texture->type == OF_IMAGE_GRAYSCALE )
+		glType = GL_LUMINANCE;
+	
+	texture->getTextureReference().allocate( texture->width, texture->height, glType );
+	texture->setUseTexture( true );
+	texture->update();
+	texture->setAnchorPercent( 0.5f, 0.5f );
+	
+	textureData = texture->getTextureReference().getTextureData();
+}
+
+void ofxParticleEmitter::resizeArrays( GLint newMaxParticles )
+{
+	// realloc keeps the particles at the front of the pool, which is where the live
+	// ones are packed, so only the ones past the new maximum are lost
+	particles = (Particle*)realloc( particles, sizeof( Particle ) * newMaxParticles );
+	vertices = (PointSprite*)realloc( vertices, sizeof( PointSprite ) * newMaxParticles );
+	
+	assert( particles && vertices );
+	
+	if ( particleCount > newMaxParticles )
+		particleCount = newMaxParticles;
+	
+	maxParticles = newMaxParticles;
+}
+
 // ------------------------------------------------------------------------
 // Particle Management
 // ------------------------------------------------------------------------
 
-bool ofxParticleEmitter::addParticle()
+int ofxParticleEmitter::emitParticles( int count )
+{
+	count = MIN( count, maxParticles - particleCount );
+	if ( count <= 0 )
+		return 0;
+	
+	// The box spawn is done in initParticle(), other shapes sample all the offsets up front
+	const Vector2f* offsets = NULL;
+	if ( shape->type != kEmitterShapeBox )
+		offsets = shape->sample( count, randomState );
+	
+	for ( int i = 0; i < count; i++ )
+		addParticle( offsets != NULL ? &offsets[i] : NULL );
+	
+	return count;
+}
+
+bool ofxParticleEmitter::addParticle( const Vector2f* offset )
 {
 	// If we have already reached the maximum number of particles then do nothing
 	if(particleCount == maxParticles)
@@ -230,7 +566,8 @@ bool ofxParticleEmitter::addParticle()
 	
 	// Take the next particle out of the particle pool we have created and initialize it
 	Particle *particle = &particles[particleCount];
-	initParticle( particle );
+	initParticle( particle, offset );
+	recordEvent( kParticleEventBirth, particle );
 	
 	// Increment the particle count
 	particleCount++;
@@ -239,63 +576,139 @@ bool ofxParticleEmitter::addParticle()
 	return true;
 }
 
-void ofxParticleEmitter::initParticle( Particle* particle )
+int ofxParticleEmitter::burst( const Vector2f& position, int count )
+{
+	// initParticle() spawns around sourcePosition, so move it for the duration of the burst.
+	// Radial burst particles keep circling the burst position once it is moved back
+	Vector2f oldSourcePosition = sourcePosition;
+	sourcePosition = position;
+	bursting = true;
+	
+	int added = emitParticles( count );
+	
+	bursting = false;
+	sourcePosition = oldSourcePosition;
+	return added;
+}
+
+void ofxParticleEmitter::setEventCapacity( int capacity )
+{
+	for ( int i = 0; i < kParticleEventCount; i++ )
+	{
+		if ( events[i] != NULL )
+			free( events[i] );
+		events[i] = NULL;
+		numEvents[i] = 0;
+		numDroppedEvents[i] = 0;
+		
+		if ( capacity > 0 )
+		{
+			events[i] = (ParticleEvent*)malloc( sizeof( ParticleEvent ) * capacity );
+			assert( events[i] );
+		}
+	}
+	
+	eventCapacity = MAX( 0, capacity );
+}
+
+void ofxParticleEmitter::retainEvents( int capacity )
+{
+	eventUsers++;
+	if ( capacity > eventCapacity )
+		setEventCapacity( capacity );
+}
+
+void ofxParticleEmitter::releaseEvents()
+{
+	if ( eventUsers > 0 && --eventUsers == 0 )
+		setEventCapacity( 0 );
+}
+
+void ofxParticleEmitter::recordEvent( int type, const Particle* particle )
+{
+	// Events past the capacity are dropped, it bounds the work anything reacting to them can cause.
+	// They are still counted so a listener can tell it missed some
+	if ( numEvents[type] >= eventCapacity )
+	{
+		if ( eventCapacity > 0 )
+			numDroppedEvents[type]++;
+		return;
+	}
+	
+	ParticleEvent* event = &events[type][numEvents[type]++];
+	event->position = particle->position;
+	event->direction = particle->direction;
+	event->color = particle->color;
+}
+
+void ofxParticleEmitter::initParticle( Particle* particle, const Vector2f* offset )
 {
 	// Init the position of the particle.  This is based on the source position of the particle emitter
-	// plus a configured variance.  The RANDOM_MINUS_1_TO_1 macro allows the number to be both positive
-	// and negative
-	particle->position.x = sourcePosition.x + sourcePositionVariance.x * RANDOM_MINUS_1_TO_1();
-	particle->position.y = sourcePosition.y + sourcePositionVariance.y * RANDOM_MINUS_1_TO_1();
+	// plus either an offset sampled from the emitter shape or a configured variance.  randomMinus1To1()
+	// allows the number to be both positive and negative
+	if ( offset != NULL )
+	{
+		particle->position = Vector2fAdd( sourcePosition, *offset );
+	}
+	else
+	{
+		particle->position.x = sourcePosition.x + sourcePositionVariance.x * randomMinus1To1();
+		particle->position.y = sourcePosition.y + sourcePositionVariance.y * randomMinus1To1();
+	}
     particle->startPos.x = sourcePosition.x;
     particle->startPos.y = sourcePosition.y;
+	particle->anchored = bursting;
 	
 	// Init the direction of the particle.  The newAngle is calculated using the angle passed in and the
 	// angle variance.
-	float newAngle = (GLfloat)DEGREES_TO_RADIANS(angle + angleVariance * RANDOM_MINUS_1_TO_1());
+	float newAngle = (GLfloat)DEGREES_TO_RADIANS(angle + angleVariance * randomMinus1To1());
 	
 	// Create a new Vector2f using the newAngle
 	Vector2f vector = Vector2fMake(cosf(newAngle), sinf(newAngle));
 	
 	// Calculate the vectorSpeed using the speed and speedVariance which has been passed in
-	float vectorSpeed = speed + speedVariance * RANDOM_MINUS_1_TO_1();
+	float vectorSpeed = speed + speedVariance * randomMinus1To1();
 	
 	// The particles direction vector is calculated by taking the vector calculated above and
 	// multiplying that by the speed
 	particle->direction = Vector2fMultiply(vector, vectorSpeed);
 	
 	// Set the default diameter of the particle from the source position
-	particle->radius = maxRadius + maxRadiusVariance * RANDOM_MINUS_1_TO_1();
+	particle->radius = maxRadius + maxRadiusVariance * randomMinus1To1();
 	particle->radiusDelta = (maxRadius / particleLifespan) * (1.0 / MAXIMUM_UPDATE_RATE);
-	particle->angle = DEGREES_TO_RADIANS(angle + angleVariance * RANDOM_MINUS_1_TO_1());
-	particle->degreesPerSecond = DEGREES_TO_RADIANS(rotatePerSecond + rotatePerSecondVariance * RANDOM_MINUS_1_TO_1());
+	particle->angle = DEGREES_TO_RADIANS(angle + angleVariance * randomMinus1To1());
+	particle->degreesPerSecond = DEGREES_TO_RADIANS(rotatePerSecond + rotatePerSecondVariance * randomMinus1To1());
     
     particle->radialAcceleration = radialAcceleration;
     particle->tangentialAcceleration = tangentialAcceleration;
 	
 	// Calculate the particles life span using the life span and variance passed in
-	particle->timeToLive = MAX(0, particleLifespan + particleLifespanVariance * RANDOM_MINUS_1_TO_1());
+	// Clamped separately as MAX would draw the random number twice
+	particle->timeToLive = particleLifespan + particleLifespanVariance * randomMinus1To1();
+	particle->timeToLive = MAX(MINIMUM_LIFESPAN, particle->timeToLive);
+	particle->lifespan = particle->timeToLive;
 	
 	// Calculate the particle size using the start and finish particle sizes
-	GLfloat particleStartSize = startParticleSize + startParticleSizeVariance * RANDOM_MINUS_1_TO_1();
-	GLfloat particleFinishSize = finishParticleSize + finishParticleSizeVariance * RANDOM_MINUS_1_TO_1();
+	GLfloat particleStartSize = startParticleSize + startParticleSizeVariance * randomMinus1To1();
+	GLfloat particleFinishSize = finishParticleSize + finishParticleSizeVariance * randomMinus1To1();
 	particle->particleSizeDelta = ((particleFinishSize - particleStartSize) / particle->timeToLive) * (1.0 / MAXIMUM_UPDATE_RATE);
 	particle->particleSize = MAX(0, particleStartSize);
 	
 	// Calculate the color the particle should have when it starts its life.  All the elements
 	// of the start color passed in along with the variance are used to calculate the star color
 	Color4f start = {0, 0, 0, 0};
-	start.red = startColor.red + startColorVariance.red * RANDOM_MINUS_1_TO_1();
-	start.green = startColor.green + startColorVariance.green * RANDOM_MINUS_1_TO_1();
-	start.blue = startColor.blue + startColorVariance.blue * RANDOM_MINUS_1_TO_1();
-	start.alpha = startColor.alpha + startColorVariance.alpha * RANDOM_MINUS_1_TO_1();
+	start.red = startColor.red + startColorVariance.red * randomMinus1To1();
+	start.green = startColor.green + startColorVariance.green * randomMinus1To1();
+	start.blue = startColor.blue + startColorVariance.blue * randomMinus1To1();
+	start.alpha = startColor.alpha + startColorVariance.alpha * randomMinus1To1();
 	
 	// Calculate the color the particle should be when its life is over.  This is done the same
 	// way as the start color above
 	Color4f end = {0, 0, 0, 0};
-	end.red = finishColor.red + finishColorVariance.red * RANDOM_MINUS_1_TO_1();
-	end.green = finishColor.green + finishColorVariance.green * RANDOM_MINUS_1_TO_1();
-	end.blue = finishColor.blue + finishColorVariance.blue * RANDOM_MINUS_1_TO_1();
-	end.alpha = finishColor.alpha + finishColorVariance.alpha * RANDOM_MINUS_1_TO_1();
+	end.red = finishColor.red + finishColorVariance.red * randomMinus1To1();
+	end.green = finishColor.green + finishColorVariance.green * randomMinus1To1();
+	end.blue = finishColor.blue + finishColorVariance.blue * randomMinus1To1();
+	end.alpha = finishColor.alpha + finishColorVariance.alpha * randomMinus1To1();
 	
 	// Calculate the delta which is to be applied to the particles color during each cycle of its
 	// life.  The delta calculation uses the life span of the particle to make sure that the 
@@ -307,6 +720,24 @@ void ofxParticleEmitter::initParticle( Particle* particle )
 	particle->deltaColor.green = ((end.green - start.green) / particle->timeToLive)  * (1.0 / MAXIMUM_UPDATE_RATE);
 	particle->deltaColor.blue = ((end.blue - start.blue) / particle->timeToLive)  * (1.0 / MAXIMUM_UPDATE_RATE);
 	particle->deltaColor.alpha = ((end.alpha - start.alpha) / particle->timeToLive)  * (1.0 / MAXIMUM_UPDATE_RATE);
+	
+	// In world space the transform is applied once here and the particle is simulated in world
+	// coordinates from then on
+	if ( transform != NULL && simulationSpace == kParticleSpaceWorld )
+	{
+		const Affine2f& world = transform->getWorldTransform();
+		GLfloat scale = Affine2fScale( world );
+		
+		particle->position = Affine2fApply( world, particle->position );
+		particle->startPos = Affine2fApply( world, particle->startPos );
+		particle->anchored = true;
+		particle->direction = Affine2fApplyLinear( world, particle->direction );
+		particle->radius *= scale;
+		particle->radiusDelta *= scale;
+		particle->angle += atan2f( world.b, world.a );
+		particle->particleSize *= scale;
+		particle->particleSizeDelta *= scale;
+	}
 }
 
 void ofxParticleEmitter::stopParticleEmitter()
@@ -323,21 +754,33 @@ void ofxParticleEmitter::stopParticleEmitter()
 void ofxParticleEmitter::update()
 {
 	if ( !active ) return;
+	
+	GLfloat aDelta = (ofGetElapsedTimeMillis()-lastUpdateMillis)/1000.0f;
+	
+	simulate( aDelta, 1.0f );
+	
+	lastUpdateMillis = ofGetElapsedTimeMillis();
+}
 
+void ofxParticleEmitter::simulate( GLfloat aDelta, GLfloat updates )
+{
 	// Calculate the emission rate
 	emissionRate = maxParticles / particleLifespan;
-
-	GLfloat aDelta = (ofGetElapsedTimeMillis()-lastUpdateMillis)/1000.0f;
 	
-	// If the emitter is active and the emission rate is greater than zero then emit
-	// particles
-	if(active && emissionRate) {
-		float rate = 1.0f/emissionRate;
+	// Start a new frame of events
+	for ( int i = 0; i < kParticleEventCount; i++ )
+		numEvents[i] = numDroppedEvents[i] = 0;
+	
+	// If the emitter is active and the emission rate is greater than zero then work out how
+	// many particles are due.  They are spawned once the existing particles have been updated
+	// so that each can be aged by the time since it was due, see ageNewParticles()
+	GLfloat rate = 0, due = 0, youngestAge = 0;
+	if(active && emitting && emissionRate) {
+		rate = 1.0f/emissionRate;
 		emitCounter += aDelta;
-		while(particleCount < maxParticles && emitCounter > rate) {
-			addParticle();
-			emitCounter -= rate;
-		}
+		due = floorf(emitCounter / rate);
+		emitCounter = fmodf(emitCounter, rate);
+		youngestAge = emitCounter;
 		
 		elapsedTime += aDelta;
 		if(duration != -1 && duration < elapsedTime)
@@ -347,96 +790,458 @@ void ofxParticleEmitter::update()
 	// Reset the particle index before updating the particles in this emitter
 	particleIndex = 0;
 	
-	// Loop through all the particles updating their location and color
-	while(particleIndex < particleCount) {
-		
-		// Get the particle for the current particle index
-		Particle *currentParticle = &particles[particleIndex];
-        
-        // FIX 1
-        // Reduce the life span of the particle
-        currentParticle->timeToLive -= aDelta;
-		
-		// If the current particle is alive then update it
-		if(currentParticle->timeToLive > 0) {
+	if ( sortMode == kParticleSortNone )
+	{
+		// Loop through all the particles updating their location and color
+		while(particleIndex < particleCount) {
 			
-			// If maxRadius is greater than 0 then the particles are going to spin otherwise
-			// they are effected by speed and gravity
-			if (emitterType == kParticleTypeRadial) {
+			// If the current particle is alive then update it
+			if(updateParticle(&particles[particleIndex], aDelta, updates)) {
 				
-                // FIX 2
-                // Update the angle of the particle from the sourcePosition and the radius.  This is only
-				// done of the particles are rotating
-				currentParticle->angle += currentParticle->degreesPerSecond * aDelta;
-				currentParticle->radius -= currentParticle->radiusDelta;
-                
-				Vector2f tmp;
-				tmp.x = sourcePosition.x - cosf(currentParticle->angle) * currentParticle->radius;
-				tmp.y = sourcePosition.y - sinf(currentParticle->angle) * currentParticle->radius;
-				currentParticle->position = tmp;
-				
-				if (currentParticle->radius < minRadius)
-					currentParticle->timeToLive = 0;
+				// Update the particle counter
+				particleIndex++;
 			} else {
-				Vector2f tmp, radial, tangential;
-                
-                radial = Vector2fZero;
-                Vector2f diff = Vector2fSub(currentParticle->startPos, Vector2fZero);
-                
-                currentParticle->position = Vector2fSub(currentParticle->position, diff);
-                
-                if (currentParticle->position.x || currentParticle->position.y)
-                    radial = Vector2fNormalize(currentParticle->position);
-                
-                tangential.x = radial.x;
-                tangential.y = radial.y;
-                radial = Vector2fMultiply(radial, currentParticle->radialAcceleration);
-                
-                GLfloat newy = tangential.x;
-                tangential.x = -tangential.y;
-                tangential.y = newy;
-                tangential = Vector2fMultiply(tangential, currentParticle->tangentialAcceleration);
-                
-				tmp = Vector2fAdd( Vector2fAdd(radial, tangential), gravity);
-                tmp = Vector2fMultiply(tmp, aDelta);
-				currentParticle->direction = Vector2fAdd(currentParticle->direction, tmp);
-				tmp = Vector2fMultiply(currentParticle->direction, aDelta);
-				currentParticle->position = Vector2fAdd(currentParticle->position, tmp);
-                currentParticle->position = Vector2fAdd(currentParticle->position, diff);
+				
+				// As the particle is not alive anymore replace it with the last active particle 
+				// in the array and reduce the count of particles by one.  This causes all active particles
+				// to be packed together at the start of the array so that a particle which has run out of
+				// life will only drop into this clause once
+				if(particleIndex != particleCount - 1)
+					particles[particleIndex] = particles[particleCount - 1];
+				particleCount--;
 			}
+		}
+	}
+	else
+	{
+		// Swapping with the last particle would scramble the draw order, so close the gaps
+		// left by dead particles instead.  This keeps the pool in spawn order
+		for ( GLint i = 0; i < particleCount; i++ )
+		{
+			if ( updateParticle( &particles[i], aDelta, updates ) )
+			{
+				if ( particleIndex != i )
+					particles[particleIndex] = particles[i];
+				particleIndex++;
+			}
+		}
+		particleCount = particleIndex;
+	}
+	
+	// Particles that were due while the pool was full are dropped rather than carried over.
+	// Only the most recent ones are spawned, after a long stall they are the ones that would
+	// still be alive
+	if ( due > 0 )
+	{
+		int emitCount = (int)MIN( due, (GLfloat)( maxParticles - particleCount ) );
+		ageNewParticles( emitParticles( emitCount ), youngestAge, rate, aDelta, updates );
+	}
+	
+	if ( sortMode == kParticleSortAge )
+		sortParticlesByAge();
+	
+	generateVertices();
+}
+
+void ofxParticleEmitter::ageNewParticles( int count, GLfloat youngestAge, GLfloat rate, GLfloat aDelta, GLfloat updates )
+{
+	// Each particle of a frame was due rate seconds before the one after it, the last one
+	// youngestAge ago.  With one update per frame this hardly matters, but a large prewarm
+	// step would otherwise spawn a whole step's particles as one clump of the same age.
+	// Dead ones are closed up so spawn order is kept for the sort modes
+	GLint kept = particleCount - count;
+	for ( GLint i = kept; i < particleCount; i++ )
+	{
+		GLfloat age = MAX( 0, MIN( aDelta, youngestAge + rate * ( particleCount - 1 - i ) ) );
+		GLfloat ageUpdates = aDelta > 0 ? updates * age / aDelta : 0;
+		
+		if ( updateParticle( &particles[i], age, ageUpdates ) )
+		{
+			if ( kept != i )
+				particles[kept] = particles[i];
+			kept++;
+		}
+	}
+	particleCount = kept;
+}
+
+bool ofxParticleEmitter::updateParticle( Particle* particle, GLfloat aDelta, GLfloat updates )
+{
+	// FIX 1
+	// Reduce the life span of the particle
+	particle->timeToLive -= aDelta;
+	
+	// If the particle has run out of life let the caller remove it
+	if(particle->timeToLive <= 0) {
+		recordEvent( kParticleEventDeath, particle );
+		return false;
+	}
+	
+	// If maxRadius is greater than 0 then the particles are going to spin otherwise
+	// they are effected by speed and gravity
+	if (emitterType == kParticleTypeRadial) {
+		
+        // FIX 2
+        // Update the angle of the particle from the sourcePosition and the radius.  This is only
+		// done of the particles are rotating
+		particle->angle += particle->degreesPerSecond * aDelta;
+		particle->radius -= particle->radiusDelta * updates;
+        
+		// Burst particles and world space particles circle where they were spawned rather than
+		// following sourcePosition or the transform
+		Vector2f center = particle->anchored ? particle->startPos : sourcePosition;
+		
+		Vector2f tmp;
+		tmp.x = center.x - cosf(particle->angle) * particle->radius;
+		tmp.y = center.y - sinf(particle->angle) * particle->radius;
+		particle->position = tmp;
+		
+		if (particle->radius < minRadius)
+			particle->timeToLive = 0;
+	} else {
+		Vector2f tmp, radial, tangential;
+        
+        radial = Vector2fZero;
+        Vector2f diff = Vector2fSub(particle->startPos, Vector2fZero);
+        
+        particle->position = Vector2fSub(particle->position, diff);
+        
+        if (particle->position.x || particle->position.y)
+            radial = Vector2fNormalize(particle->position);
+        
+        tangential.x = radial.x;
+        tangential.y = radial.y;
+        radial = Vector2fMultiply(radial, particle->radialAcceleration);
+        
+        GLfloat newy = tangential.x;
+        tangential.x = -tangential.y;
+        tangential.y = newy;
+        tangential = Vector2fMultiply(tangential, particle->tangentialAcceleration);
+        
+		tmp = Vector2fAdd( Vector2fAdd(radial, tangential), gravity);
+        tmp = Vector2fMultiply(tmp, aDelta);
+		particle->direction = Vector2fAdd(particle->direction, tmp);
+		tmp = Vector2fMultiply(particle->direction, aDelta);
+		particle->position = Vector2fAdd(particle->position, tmp);
+        particle->position = Vector2fAdd(particle->position, diff);
+	}
+	
+	// Update the particles color.  The deltas are per update, updates is only more than one
+	// when prewarming with large steps
+	particle->color.red += particle->deltaColor.red * updates;
+	particle->color.green += particle->deltaColor.green * updates;
+	particle->color.blue += particle->deltaColor.blue * updates;
+	particle->color.alpha += particle->deltaColor.alpha * updates;
+	
+	// Update the particles size
+	particle->particleSize += particle->particleSizeDelta * updates;
+	
+	return true;
+}
+
+void ofxParticleEmitter::generateVertices()
+{
+	// Local space particles are moved by the transform here, once per particle per frame,
+	// so the simulation itself never has to know about it
+	if ( transform != NULL && simulationSpace == kParticleSpaceLocal )
+	{
+		const Affine2f& world = transform->getWorldTransform();
+		GLfloat scale = Affine2fScale( world );
+		
+		for ( GLint i = 0; i < particleCount; i++ )
+		{
+			Particle* particle = &particles[i];
+			Vector2f position = Affine2fApply( world, particle->position );
 			
-			// Update the particles color
-			currentParticle->color.red += currentParticle->deltaColor.red;
-			currentParticle->color.green += currentParticle->deltaColor.green;
-			currentParticle->color.blue += currentParticle->deltaColor.blue;
-			currentParticle->color.alpha += currentParticle->deltaColor.alpha;
-			
-			// Place the position of the current particle into the vertices array
-			vertices[particleIndex].x = currentParticle->position.x;
-			vertices[particleIndex].y = currentParticle->position.y;
-			
-			// Place the size of the current particle in the size array
-			currentParticle->particleSize += currentParticle->particleSizeDelta;
-			vertices[particleIndex].size = MAX(0, currentParticle->particleSize);
-			
-			// Place the color of the current particle into the color array
-			vertices[particleIndex].color = currentParticle->color;
-			
-			// Update the particle counter
-			particleIndex++;
-		} else {
-			
-			// As the particle is not alive anymore replace it with the last active particle 
-			// in the array and reduce the count of particles by one.  This causes all active particles
-			// to be packed together at the start of the array so that a particle which has run out of
-			// life will only drop into this clause once
-			if(particleIndex != particleCount - 1)
-				particles[particleIndex] = particles[particleCount - 1];
-			particleCount--;
+			vertices[i].x = position.x;
+			vertices[i].y = position.y;
+			vertices[i].size = MAX(0, particle->particleSize) * scale;
+			vertices[i].color = particle->color;
 		}
+		return;
+	}
+	
+	for ( GLint i = 0; i < particleCount; i++ )
+	{
+		Particle* particle = &particles[i];
+		
+		// Place the position, size and color of the particle into the vertices array
+		vertices[i].x = particle->position.x;
+		vertices[i].y = particle->position.y;
+		vertices[i].size = MAX(0, particle->particleSize);
+		vertices[i].color = particle->color;
+	}
+}
+
+void ofxParticleEmitter::sortParticlesByAge()
+{
+	// Soonest to die first so the freshest particles are drawn on top.  Every particle loses
+	// the same time per update and dead ones are closed up in order, so last frame's order
+	// still holds.  Only the particles spawned since then, which were appended, are out of
+	// place: find where the sorted run ends, sort the rest and merge it in from the back
+	GLint sorted = 1;
+	while ( sorted < particleCount && particles[sorted - 1].timeToLive <= particles[sorted].timeToLive )
+		sorted++;
+	if ( sorted >= particleCount )
+		return;
+	
+	GLint count = radixSortParticlesByAge( sorted );
+	
+	// Only the sorted particles that live longer than the shortest lived new one are moved
+	GLint i = sorted - 1, k = particleCount - 1;
+	for ( GLint j = count - 1; j >= 0; k-- )
+	{
+		if ( i >= 0 && particles[i].timeToLive > sortScratch[j].timeToLive )
+			particles[k] = particles[i--];
+		else
+			particles[k] = sortScratch[j--];
+	}
+}
+
+GLint ofxParticleEmitter::radixSortParticlesByAge( GLint first )
+{
+	if ( sortCapacity < maxParticles )
+	{
+		sortScratch = (Particle*)realloc( sortScratch, sizeof( Particle ) * maxParticles );
+		sortKeys = (GLuint*)realloc( sortKeys, sizeof( GLuint ) * maxParticles * 3 );
+		assert( sortScratch && sortKeys );
+		sortCapacity = maxParticles;
+	}
+	
+	// Live particles have a positive time to live, and the bits of positive floats sort the
+	// same way as the floats, so they are exact keys.  Four 8 bit passes, ping ponging the
+	// indices
+	GLint count = particleCount - first;
+	GLuint* keys = sortKeys;
+	GLuint* indicesA = sortKeys + sortCapacity;
+	GLuint* indicesB = sortKeys + sortCapacity * 2;
+	
+	for ( GLint i = 0; i < count; i++ )
+	{
+		GLfloat timeToLive = particles[first + i].timeToLive > 0.0f ? particles[first + i].timeToLive : 0.0f;
+		memcpy( &keys[i], &timeToLive, sizeof( GLuint ) );
+		indicesA[i] = i;
+	}
+	
+	for ( int shift = 0; shift < 32; shift += 8 )
+	{
+		GLuint counts[257];
+		memset( counts, 0, sizeof( counts ) );
+		
+		for ( GLint i = 0; i < count; i++ )
+			counts[( ( keys[indicesA[i]] >> shift ) & 0xff ) + 1]++;
+		
+		// Skip passes where every key has the same digit
+		if ( counts[( ( keys[indicesA[0]] >> shift ) & 0xff ) + 1] == (GLuint)count )
+			continue;
+		
+		for ( int d = 0; d < 256; d++ )
+			counts[d + 1] += counts[d];
+		for ( GLint i = 0; i < count; i++ )
+			indicesB[counts[( keys[indicesA[i]] >> shift ) & 0xff]++] = indicesA[i];
+		
+		GLuint* swap = indicesA;
+		indicesA = indicesB;
+		indicesB = swap;
+	}
+	
+	// Gather into the scratch pool
+	for ( GLint i = 0; i < count; i++ )
+		sortScratch[i] = particles[first + indicesA[i]];
+	
+	return count;
+}
+
+// ------------------------------------------------------------------------
+// Prewarm and State
+// ------------------------------------------------------------------------
+
+void ofxParticleEmitter::prewarm( GLfloat seconds, GLfloat stepSeconds /* = 0.1f */ )
+{
+	if ( !active || seconds <= 0 || stepSeconds <= 0 ) return;
+	
+	// Every particle spawned before the longest possible lifespan will have died by the end,
+	// so that part can be skipped rather than simulated.  Only the elapsed time is advanced
+	// so that a duration still applies
+	GLfloat longest = particleLifespan + fabsf( particleLifespanVariance );
+	GLfloat skipped = MAX( 0, seconds - longest );
+	
+	elapsedTime += skipped;
+	if ( duration != -1 && duration < elapsedTime )
+	{
+		stopParticleEmitter();
+		return;
+	}
+	
+	// The per update deltas assume updates happen at the app frame rate, so each step counts
+	// for as many updates as frames it covers.  Spawn times and the color, size and radial
+	// motion are exact for any step, only gravity and acceleration are integrated per step
+	GLfloat updatesPerSecond = ofGetFrameRate() > 0 ? ofGetFrameRate() : 60.0f;
+	
+	for ( GLfloat remaining = seconds - skipped; remaining > 0 && active; remaining -= stepSeconds )
+	{
+		GLfloat step = MIN( stepSeconds, remaining );
+		simulate( step, step * updatesPerSecond );
+	}
+	
+	lastUpdateMillis = ofGetElapsedTimeMillis();
+}
+
+// Header written before the particles in a state snapshot
+typedef struct
+{
+	char		magic[4];
+	GLuint		version;
+	GLuint		particleSize;
+	GLint		maxParticles;
+	GLint		particleCount;
+	GLfloat		emitCounter;
+	GLfloat		elapsedTime;
+	GLuint		randomState;
+	Vector2f	sourcePosition;
+	GLint		active;
+	GLint		emitting;
+} ParticleStateHeader;
+
+static const char	kParticleStateMagic[4] = { 'O', 'P', 'E', 'S' };
+static const GLuint	kParticleStateVersion = 2;
+
+// True if every float of a particle is finite, anchored is the only field that isn't a float
+static bool isParticleFinite( const Particle& particle )
+{
+	const GLfloat* values = (const GLfloat*)&particle;
+	for ( size_t i = 0; i < offsetof( Particle, anchored ) / sizeof( GLfloat ); i++ )
+	{
+		if ( !isFinite( values[i] ) )
+			return false;
 	}
+	return true;
+}
+
+void ofxParticleEmitter::saveState( std::vector<unsigned char>& buffer ) const
+{
+	ParticleStateHeader header;
+	memcpy( header.magic, kParticleStateMagic, sizeof( header.magic ) );
+	header.version = kParticleStateVersion;
+	header.particleSize = sizeof( Particle );
+	header.maxParticles = maxParticles;
+	header.particleCount = particleCount;
+	header.emitCounter = emitCounter;
+	header.elapsedTime = elapsedTime;
+	header.randomState = randomState;
+	header.sourcePosition = sourcePosition;
+	header.active = active;
+	header.emitting = emitting;
+	
+	buffer.resize( sizeof( header ) + sizeof( Particle ) * particleCount );
+	memcpy( &buffer[0], &header, sizeof( header ) );
+	if ( particleCount > 0 )
+		memcpy( &buffer[sizeof( header )], particles, sizeof( Particle ) * particleCount );
+}
 
+bool ofxParticleEmitter::restoreState( const std::vector<unsigned char>& buffer )
+{
+	if ( !loaded )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitter::restoreState() - emitter is not loaded!" );
+		return false;
+	}
+	
+	ParticleStateHeader header;
+	if ( buffer.size() < sizeof( header ) )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitter::restoreState() - state is truncated!" );
+		return false;
+	}
+	memcpy( &header, &buffer[0], sizeof( header ) );
+	
+	if ( memcmp( header.magic, kParticleStateMagic, sizeof( header.magic ) ) != 0 ||
+		header.version != kParticleStateVersion || header.particleSize != sizeof( Particle ) ||
+		header.maxParticles > MAXIMUM_PARTICLES ||
+		header.particleCount < 0 || header.particleCount > header.maxParticles ||
+		buffer.size() != sizeof( header ) + sizeof( Particle ) * header.particleCount )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitter::restoreState() - state is invalid or from another version!" );
+		return false;
+	}
+	
+	// The state skips validateConfig(), so check it before anything is restored
+	bool finite = isFinite( header.emitCounter ) && isFinite( header.elapsedTime ) &&
+		isFinite( header.sourcePosition.x ) && isFinite( header.sourcePosition.y );
+	for ( GLint i = 0; i < header.particleCount && finite; i++ )
+	{
+		Particle particle;
+		memcpy( &particle, &buffer[sizeof( header ) + sizeof( Particle ) * i], sizeof( Particle ) );
+		finite = isParticleFinite( particle );
+	}
+	if ( !finite )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitter::restoreState() - state holds NaN or infinite values!" );
+		return false;
+	}
+	
+	// Only grow the pool as far as the saved particles need
+	if ( header.particleCount > maxParticles )
+	{
+		ofLog( OF_LOG_WARNING, "ofxParticleEmitter::restoreState() - state holds more particles than maxParticles, raised to " + ofToString( header.particleCount ) + "!" );
+		resizeArrays( header.particleCount );
+	}
+	
+	particleCount = header.particleCount;
+	if ( particleCount > 0 )
+		memcpy( particles, &buffer[sizeof( header )], sizeof( Particle ) * particleCount );
+	
+	emitCounter = header.emitCounter;
+	elapsedTime = header.elapsedTime;
+	randomState = header.randomState;
+	sourcePosition = header.sourcePosition;
+	active = header.active != 0;
+	emitting = header.emitting != 0;
+	
+	generateVertices();
+	particleIndex = particleCount;
 	lastUpdateMillis = ofGetElapsedTimeMillis();
+	
+	return true;
+}
+
+bool ofxParticleEmitter::saveStateToFile( const std::string& filename ) const
+{
+	std::vector<unsigned char> buffer;
+	saveState( buffer );
+	
+	std::ofstream file( ofToDataPath( filename ).c_str(), std::ios::out | std::ios::binary );
+	if ( !file.is_open() )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitter::saveStateToFile() - could not open " + filename );
+		return false;
+	}
+	
+	file.write( (const char*)&buffer[0], buffer.size() );
+	return file.good();
+}
+
+bool ofxParticleEmitter::loadStateFromFile( const std::string& filename )
+{
+	std::ifstream file( ofToDataPath( filename ).c_str(), std::ios::in | std::ios::binary );
+	if ( !file.is_open() )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitter::loadStateFromFile() - could not open " + filename );
+		return false;
+	}
+	
+	file.seekg( 0, std::ios::end );
+	std::streamoff size = file.tellg();
+	file.seekg( 0, std::ios::beg );
+	if ( size <= 0 )
+		return false;
+	
+	std::vector<unsigned char> buffer( (size_t)size );
+	file.read( (char*)&buffer[0], size );
+	if ( !file.good() )
+		return false;
+	
+	return restoreState( buffer );
 }
 
 // ------------------------------------------------------------------------
@@ -456,7 +1261,7 @@ void ofxParticleEmitter::draw(int x /* = 0 */, int y /* = 0 */)
 	
 #else
 	
-	drawTextures();
+	drawTextures( vertices, particleCount );
 	//drawPoints();
 	
 #endif
@@ -464,14 +1269,26 @@ void ofxParticleEmitter::draw(int x /* = 0 */, int y /* = 0 */)
 	glPopMatrix();
 }
 
-void ofxParticleEmitter::drawTextures()
+void ofxParticleEmitter::drawSprites( const PointSprite* sprites, int count, int x /* = 0 */, int y /* = 0 */ )
+{
+	if ( texture == NULL || sprites == NULL ) return;
+	
+	glPushMatrix();
+	glTranslatef( x, y, 0.0f );
+	
+	drawTextures( sprites, count );
+	
+	glPopMatrix();
+}
+
+void ofxParticleEmitter::drawTextures( const PointSprite* sprites, int count )
 {
 	glEnable(GL_BLEND);
 	glBlendFunc(blendFuncSource, blendFuncDestination);
 	
-	for( int i = 0; i < particleCount; i++ )
+	for( int i = 0; i < count; i++ )
 	{
-		PointSprite* ps = &vertices[i];
+		const PointSprite* ps = &sprites[i];
 		ofSetColor( ps->color.red*255.0f, ps->color.green*255.0f, 
 				   ps->color.blue*255.0f, ps->color.alpha*255.0f );
 		texture->draw( ps->x, ps->y, ps->size, ps->size );
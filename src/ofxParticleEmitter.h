@@ -45,6 +45,14 @@ typedef struct {
 	GLfloat y;
 } Vector2f;
 
+// Structure that defines where an emitters texture lives in an atlas page.  The
+// texture coordinates are normalized, page is -1 when the emitter isn't in an atlas
+typedef struct {
+	GLint	page;
+	GLfloat	u1, v1;
+	GLfloat	u2, v2;
+} AtlasRegion;
+
 // Particle type
 enum kParticleTypes 
 {
@@ -52,6 +60,37 @@ enum kParticleTypes
 	kParticleTypeRadial
 };
 
+// Particle sort mode, controls the order particles are drawn in
+enum kParticleSortModes
+{
+	kParticleSortNone,			// Fastest, the order changes as particles die
+	kParticleSortSpawnOrder,	// Oldest spawned particle first
+	kParticleSortAge			// Soonest to die first, by the time the particles have left to live
+};
+
+// Space the particles of an emitter with a transform are simulated in
+enum kParticleSimulationSpaces
+{
+	kParticleSpaceWorld,	// Placed by the transform when they spawn, left behind when it moves
+	kParticleSpaceLocal		// Follow the transform, applied when the vertices are generated
+};
+
+// Particle lifecycle events that can be recorded during update()
+enum kParticleEvents
+{
+	kParticleEventBirth,
+	kParticleEventDeath,
+	kParticleEventCount
+};
+
+// Structure that holds a particle lifecycle event
+typedef struct
+{
+	Vector2f	position;
+	Vector2f	direction;
+	Color4f		color;
+} ParticleEvent;
+
 // Structure that holds the location and size for each point sprite
 typedef struct 
 {
@@ -78,6 +117,8 @@ typedef struct
 	GLfloat		particleSize;
 	GLfloat		particleSizeDelta;
 	GLfloat		timeToLive;
+	GLfloat		lifespan;
+	GLint		anchored;		// Radial particles circle startPos rather than sourcePosition
 } Particle;
 
 // ------------------------------------------------------------------------
@@ -154,7 +195,28 @@ static inline Vector2f Vector2fNormalize(Vector2f v) {
 	return Vector2fMultiply(v, 1.0f/Vector2fLength(v));
 }
 
+// Return value clamped to +/- limit, or 0 if it is NaN or infinite
+static inline GLfloat ClampFinite(GLfloat value, GLfloat limit) {
+	if (!(value - value == 0.0f))
+		return 0.0f;
+	return MAX(-limit, MIN(value, limit));
+}
+
+// Advance the xorshift32 state and return a random number between 0 and 1
+static inline GLfloat Xorshift32Random0To1(GLuint& state) {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return (state >> 8) * (1.0f / 16777216.0f);
+}
+
 #define MAXIMUM_UPDATE_RATE 90.0f	// The maximum number of updates that occur per frame
+#define MAXIMUM_PARTICLES 100000	// Configs asking for more particles are clamped to this
+#define MINIMUM_LIFESPAN 0.001f		// Shortest lifespan in seconds, avoids dividing by zero
+#define MAXIMUM_CONFIG_VALUE 1000000.0f	// Config values are clamped to +/- this so the simulation can't overflow
+
+class ofxParticleEmitterShape;
+class ofxParticleTransform;
 
 // ------------------------------------------------------------------------
 // ofxParticleEmitter
@@ -169,9 +231,91 @@ public:
 	~ofxParticleEmitter();
 	
 	bool	loadFromXml( const std::string& filename );
+	
+	// Loading split into two stages so it can be done in the background (see
+	// ofxParticleEmitterLoader).  loadConfig() parses the XML and decodes the texture
+	// pixels without touching GL so it is safe to call from a worker thread,
+	// finishLoading() uploads the texture and must be called from the GL thread
+	bool	loadConfig( const std::string& filename );
+	bool	loadConfigFromString( const std::string& xml );
+	void	finishLoading();
+	bool	isLoaded() const { return loaded; }
+	bool	isActive() const { return active; }		// False once duration has run out
+	
+	// Re-parse a config into an already loaded emitter without dropping its live
+	// particles.  The pools are only reallocated if maxParticles changed and the texture
+	// only reloaded if its name changed.  sourcePosition is left alone as it is usually
+	// driven by the app.  Must be called from the GL thread
+	bool	reloadFromXml( const std::string& filename );
+	
 	void	update();
 	void	draw( int x = 0, int y = 0 );
 	void	exit();
+	
+	// Draw sprites that didn't come from this emitter's simulation, e.g. a recording, using
+	// this emitter's texture and blend functions
+	void	drawSprites( const PointSprite* sprites, int count, int x = 0, int y = 0 );
+	
+	const PointSprite*	getVertices() const { return vertices; }
+	GLint				getParticleCount() const { return particleCount; }
+	ofImage*			getTexture() { return texture; }
+	const std::string&	getTextureFilename() const { return textureFilename; }
+	
+	// Generate vertices into buffer, which must hold maxParticles sprites, and return the
+	// array used until now.  ofxParticlePipeline uses it to simulate into its own buffers
+	PointSprite*		swapVertices( PointSprite* buffer ) { PointSprite* old = vertices; vertices = buffer; return old; }
+	
+	// Copy the configuration of a loaded emitter, sharing its texture rather than loading
+	// it again.  The source must outlive this emitter.  Must be called from the GL thread
+	void	copyConfig( const ofxParticleEmitter& source );
+	
+	// Continuous emission can be switched off to only spawn particles through burst()
+	void	setEmitting( bool emitting ) { this->emitting = emitting; }
+	bool	isEmitting() const { return emitting; }
+	int		burst( const Vector2f& position, int count );
+	
+	// Birth and death events are collected into fixed size arrays during each update(), up to
+	// capacity per type and frame.  A capacity of 0 (the default) turns recording off
+	void					setEventCapacity( int capacity );
+	int						getEventCapacity() const { return eventCapacity; }
+	const ParticleEvent*	getEvents( int type ) const { return events[type]; }
+	int						getNumEvents( int type ) const { return numEvents[type]; }
+	int						getNumDroppedEvents( int type ) const { return numDroppedEvents[type]; }
+	
+	// Shared use of the event arrays, e.g. by several ofxParticleSubEmitters.  The capacity only
+	// grows while there are users and recording is switched off when the last one releases it
+	void					retainEvents( int capacity );
+	void					releaseEvents();
+	
+	// Simulate seconds ahead so effects don't visibly fill in after loading.  Only the last
+	// lifespan worth of time is simulated, in steps of stepSeconds.  Particles spawned within
+	// a step are aged by when they were due, so large steps don't clump them; smaller steps
+	// only make accelerated motion more accurate
+	void	prewarm( GLfloat seconds, GLfloat stepSeconds = 0.1f );
+	
+	// Snapshot of the simulation state, that is the live particles, emit counter, elapsed time
+	// and random state.  The config isn't included so restore into an emitter loaded from the
+	// same .pex.  The format is native endian and tied to the Particle layout.  States with
+	// NaN or infinite values are rejected, maxParticles is raised if the saved particles don't fit
+	void	saveState( std::vector<unsigned char>& buffer ) const;
+	bool	restoreState( const std::vector<unsigned char>& buffer );
+	bool	saveStateToFile( const std::string& filename ) const;
+	bool	loadStateFromFile( const std::string& filename );
+	
+	void	setRandomSeed( GLuint seed ) { randomState = seed ? seed : 1; }
+	
+	// Set by ofxParticleAtlas::build(), emitters with a region are batched by ofxParticleSystem
+	void				setAtlasRegion( const AtlasRegion& region ) { atlasRegion = region; }
+	const AtlasRegion&	getAtlasRegion() const { return atlasRegion; }
+	
+	// Spawn shape, read from the emitterShape* tags of the .pex (see ofxParticleEmitterShape)
+	ofxParticleEmitterShape*	getShape() { return shape; }
+	
+	// Optional transform, sourcePosition and the spawn shape are relative to it.  Its world
+	// transform has to be current before update(), ofxParticleSystem takes care of that for
+	// its emitters.  The transform must outlive the emitter
+	void					setTransform( ofxParticleTransform* transform ) { this->transform = transform; }
+	ofxParticleTransform*	getTransform() const { return transform; }
 
 	int				emitterType;
 	Vector2f		sourcePosition, sourcePositionVariance;			
@@ -189,6 +333,9 @@ public:
 	GLint			particleCount;
 	GLfloat			duration;
 	int				blendFuncSource, blendFuncDestination;
+	int				sortMode;			// One of kParticleSortModes
+	int				layer;				// ofxParticleSystem draws lower layers first
+	int				simulationSpace;	// One of kParticleSimulationSpaces
 
 	// Particle ivars only used when a maxRadius value is provided.  These values are used for
 	// the special purpose of creating the spinning portal emitter
@@ -201,33 +348,65 @@ public:
 	
 protected:
 	
-	void	parseParticleConfig();
+	bool	loadSettings( bool ok );
+	bool	parseParticleConfig();
+	void	validateConfig();
 	void	setupArrays();
+	void	resizeArrays( GLint newMaxParticles );
+	void	uploadTexture();
 	
+	void	simulate( GLfloat aDelta, GLfloat updates );
 	void	stopParticleEmitter();
-	bool	addParticle();
-	void	initParticle( Particle* particle );
+	int		emitParticles( int count );
+	bool	addParticle( const Vector2f* offset = NULL );
+	void	ageNewParticles( int count, GLfloat youngestAge, GLfloat rate, GLfloat aDelta, GLfloat updates );
+	void	recordEvent( int type, const Particle* particle );
+	void	initParticle( Particle* particle, const Vector2f* offset );
+	bool	updateParticle( Particle* particle, GLfloat aDelta, GLfloat updates );
+	void	generateVertices();
+	void	sortParticlesByAge();
+	GLint	radixSortParticlesByAge( GLint first );	// Sorts from first on into sortScratch
+	
+	// Per emitter random numbers so the random state can be saved with the rest of the simulation
+	inline GLfloat random0To1() { return Xorshift32Random0To1( randomState ); }
+	inline GLfloat randomMinus1To1() { return random0To1() * 2.0f - 1.0f; }
 	
-	void	drawTextures();
+	void	drawTextures( const PointSprite* sprites, int count );
 	void	drawPoints();
 	void	drawPointsOES();
 	
 	ofxXmlSettings*	settings;
 
 	ofImage*		texture;												
+	std::string		textureFilename;
+	AtlasRegion		atlasRegion;
+	ofxParticleEmitterShape*	shape;
+	ofxParticleTransform*		transform;
 	ofTextureData	textureData;
 	
 	GLfloat			emissionRate;
 	GLfloat			emitCounter;	
 	GLfloat			elapsedTime;
 	int				lastUpdateMillis;
+	GLuint			randomState;
 
-	bool			active, useTexture;
+	bool			active, useTexture, loaded, emitting, ownsTexture, bursting;
+	bool			textureChanged;	// Set by parseParticleConfig() when it loaded a new image
 	GLint			particleIndex;	// Stores the number of particles that are going to be rendered
 
 	GLuint			verticesID;		// Holds the buffer name of the VBO that stores the color and vertices info for the particles
 	Particle*		particles;		// Array of particles that hold the particle emitters particle details
 	PointSprite*	vertices;		// Array of vertices and color information for each particle to be rendered
+	
+	Particle*		sortScratch;	// Scratch pool and keys for radix sorting, only allocated when needed
+	GLuint*			sortKeys;
+	GLint			sortCapacity;
+	
+	ParticleEvent*	events[kParticleEventCount];
+	int				numEvents[kParticleEventCount];
+	int				numDroppedEvents[kParticleEventCount];	// Events past the capacity this frame
+	int				eventCapacity;
+	int				eventUsers;
 };
 
 #endif
\ No newline at end of file
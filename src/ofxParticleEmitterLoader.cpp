@@ -0,0 +1,231 @@
+//
+// ofxParticleEmitterLoader.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticleEmitterLoader.h"
+
+// ------------------------------------------------------------------------
+// Lifecycle
+// ------------------------------------------------------------------------
+
+ofxParticleEmitterLoader::ofxParticleEmitterLoader()
+{
+	running = false;
+	numDecoding = 0;
+}
+
+ofxParticleEmitterLoader::~ofxParticleEmitterLoader()
+{
+	exit();
+}
+
+void ofxParticleEmitterLoader::exit()
+{
+	if ( running )
+	{
+		mutex.lock();
+		running = false;
+		mutex.unlock();
+		
+		wakeEvent.set();
+		thread.join();
+	}
+	
+	// Loads that were still queued will never finish
+	for ( unsigned int i = 0; i < loadStates.size(); i++ )
+	{
+		if ( loadStates[i] == kEmitterLoadPending )
+			loadStates[i] = kEmitterLoadFailed;
+	}
+	
+	pending.clear();
+	decoded.clear();
+	numDecoding = 0;
+	
+	std::map<std::string, ofxParticleEmitter*>::iterator it;
+	for ( it = library.begin(); it != library.end(); ++it )
+		delete it->second;
+	library.clear();
+}
+
+void ofxParticleEmitterLoader::startThread()
+{
+	if ( running ) return;
+	
+	running = true;
+	thread.start( *this );
+}
+
+// ------------------------------------------------------------------------
+// Requests
+// ------------------------------------------------------------------------
+
+int ofxParticleEmitterLoader::load( ofxParticleEmitter* emitter, const std::string& filename )
+{
+	if ( emitter == NULL )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitterLoader::load() - emitter is invalid!" );
+		return -1;
+	}
+	
+	// Release anything from a previous load now, while we are still on the GL thread
+	if ( emitter->isLoaded() )
+		emitter->exit();
+	
+	LoadRequest request;
+	request.emitter = emitter;
+	request.filename = filename;
+	request.handle = loadStates.size();
+	request.ok = false;
+	loadStates.push_back( kEmitterLoadPending );
+	
+	mutex.lock();
+	pending.push_back( request );
+	mutex.unlock();
+	
+	startThread();
+	wakeEvent.set();
+	
+	return request.handle;
+}
+
+int ofxParticleEmitterLoader::getLoadState( int handle )
+{
+	if ( handle < 0 || handle >= (int)loadStates.size() )
+		return kEmitterLoadFailed;
+	
+	return loadStates[handle];
+}
+
+void ofxParticleEmitterLoader::preload( const std::vector<std::string>& filenames )
+{
+	for ( unsigned int i = 0; i < filenames.size(); i++ )
+	{
+		if ( library.find( filenames[i] ) != library.end() )
+			continue;
+		
+		ofxParticleEmitter* emitter = new ofxParticleEmitter();
+		library[filenames[i]] = emitter;
+		load( emitter, filenames[i] );
+	}
+}
+
+ofxParticleEmitter* ofxParticleEmitterLoader::getEmitter( const std::string& filename )
+{
+	std::map<std::string, ofxParticleEmitter*>::iterator it = library.find( filename );
+	if ( it == library.end() || !it->second->isLoaded() )
+		return NULL;
+	
+	return it->second;
+}
+
+int ofxParticleEmitterLoader::getNumPending()
+{
+	Poco::FastMutex::ScopedLock lock( mutex );
+	return pending.size() + decoded.size() + numDecoding;
+}
+
+int ofxParticleEmitterLoader::getNumDecoded()
+{
+	Poco::FastMutex::ScopedLock lock( mutex );
+	return decoded.size();
+}
+
+bool ofxParticleEmitterLoader::isIdle()
+{
+	return getNumPending() == 0;
+}
+
+// ------------------------------------------------------------------------
+// Update
+// ------------------------------------------------------------------------
+
+void ofxParticleEmitterLoader::update( int budgetMillis /* = 2 */ )
+{
+	int startMillis = ofGetElapsedTimeMillis();
+	
+	// Always upload at least one emitter per call so a tight budget can't starve the queue
+	do {
+		mutex.lock();
+		if ( decoded.empty() )
+		{
+			mutex.unlock();
+			return;
+		}
+		LoadRequest request = decoded.front();
+		decoded.pop_front();
+		mutex.unlock();
+		
+		if ( request.ok )
+		{
+			request.emitter->finishLoading();
+			loadStates[request.handle] = kEmitterLoadDone;
+		}
+		else
+		{
+			loadStates[request.handle] = kEmitterLoadFailed;
+			ofLog( OF_LOG_ERROR, "ofxParticleEmitterLoader::update() - failed to load " + request.filename );
+			
+			std::map<std::string, ofxParticleEmitter*>::iterator it = library.find( request.filename );
+			if ( it != library.end() && it->second == request.emitter )
+			{
+				delete it->second;
+				library.erase( it );
+			}
+		}
+	} while ( ofGetElapsedTimeMillis() - startMillis < budgetMillis );
+}
+
+// ------------------------------------------------------------------------
+// Worker thread
+// ------------------------------------------------------------------------
+
+void ofxParticleEmitterLoader::run()
+{
+	while ( true )
+	{
+		mutex.lock();
+		if ( !running )
+		{
+			mutex.unlock();
+			break;
+		}
+		if ( pending.empty() )
+		{
+			mutex.unlock();
+			wakeEvent.wait();
+			continue;
+		}
+		LoadRequest request = pending.front();
+		pending.pop_front();
+		numDecoding++;
+		mutex.unlock();
+		
+		// This is the slow part, XML parsing and image decoding
+		request.ok = request.emitter->loadConfig( request.filename );
+		
+		mutex.lock();
+		decoded.push_back( request );
+		numDecoding--;
+		mutex.unlock();
+	}
+}
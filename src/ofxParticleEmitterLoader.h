@@ -0,0 +1,106 @@
+//
+// ofxParticleEmitterLoader.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_EMITTER_LOADER
+#define _OFX_PARTICLE_EMITTER_LOADER
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Mutex.h"
+#include "Poco/Event.h"
+
+// State of a load() handle
+enum kEmitterLoadStates
+{
+	kEmitterLoadPending,	// Queued, decoding or waiting for update() to upload it
+	kEmitterLoadDone,		// Uploaded, the emitter is usable
+	kEmitterLoadFailed		// The config or its texture couldn't be loaded, or exit() was called
+};
+
+// ------------------------------------------------------------------------
+// ofxParticleEmitterLoader
+// ------------------------------------------------------------------------
+
+// Loads emitter configs in the background.  The XML parsing and image decoding
+// happens on a worker thread, only the texture upload is left for update() which
+// must be called once per frame from the GL thread.  An emitter is usable (its
+// isLoaded() returns true) from the frame its upload has been done, which the
+// handle returned by load() reports as well.
+class ofxParticleEmitterLoader : public Poco::Runnable
+{
+	
+public:
+	
+	ofxParticleEmitterLoader();
+	~ofxParticleEmitterLoader();
+	
+	// Queue an emitter owned by the caller and return a handle for getLoadState(), or -1.
+	// The emitter must stay alive and must not be loaded again while the load is pending.
+	// Handles aren't reused
+	int		load( ofxParticleEmitter* emitter, const std::string& filename );
+	int		getLoadState( int handle );	// One of kEmitterLoadStates, unknown handles have failed
+	
+	// Queue a whole library of effects, owned by the loader and fetched by filename
+	void	preload( const std::vector<std::string>& filenames );
+	ofxParticleEmitter*	getEmitter( const std::string& filename );	// NULL until loaded
+	
+	// Upload decoded emitters to the GPU, spending at most budgetMillis per call
+	void	update( int budgetMillis = 2 );
+	void	exit();
+	
+	int		getNumPending();
+	int		getNumDecoded();	// Decoded and waiting for update()
+	bool	isIdle();
+	
+	void	run();
+	
+protected:
+	
+	typedef struct
+	{
+		ofxParticleEmitter*	emitter;
+		std::string			filename;
+		int					handle;
+		bool				ok;
+	} LoadRequest;
+	
+	void	startThread();
+	
+	Poco::Thread					thread;
+	Poco::FastMutex					mutex;
+	Poco::Event						wakeEvent;
+	bool							running;
+	
+	std::deque<LoadRequest>			pending;	// waiting to be decoded, guarded by mutex
+	std::deque<LoadRequest>			decoded;	// waiting to be uploaded, guarded by mutex
+	int								numDecoding;
+	
+	std::vector<unsigned char>		loadStates;	// Indexed by handle, only used on the GL thread
+	
+	std::map<std::string, ofxParticleEmitter*>	library;
+};
+
+#endif
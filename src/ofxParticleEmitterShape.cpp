@@ -0,0 +1,403 @@
+//
+// ofxParticleEmitterShape.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticleEmitterShape.h"
+
+// ------------------------------------------------------------------------
+// ofxParticleAliasTable
+// ------------------------------------------------------------------------
+
+bool ofxParticleAliasTable::build( const std::vector<GLfloat>& weights )
+{
+	clear();
+	
+	int count = (int)weights.size();
+	double total = 0.0;
+	for ( int i = 0; i < count; i++ )
+		total += MAX( 0.0f, weights[i] );
+	if ( count == 0 || total <= 0.0 )
+		return false;
+	
+	probability.resize( count );
+	alias.resize( count );
+	
+	// Scale the weights so they average 1, then pair every entry below 1 with one above
+	std::vector<double> scaled( count );
+	std::vector<int> small, large;
+	for ( int i = 0; i < count; i++ )
+	{
+		scaled[i] = MAX( 0.0f, weights[i] ) * count / total;
+		if ( scaled[i] < 1.0 )
+			small.push_back( i );
+		else
+			large.push_back( i );
+	}
+	
+	while ( !small.empty() && !large.empty() )
+	{
+		int s = small.back(); small.pop_back();
+		int l = large.back(); large.pop_back();
+		
+		probability[s] = (GLfloat)scaled[s];
+		alias[s] = l;
+		
+		scaled[l] = ( scaled[l] + scaled[s] ) - 1.0;
+		if ( scaled[l] < 1.0 )
+			small.push_back( l );
+		else
+			large.push_back( l );
+	}
+	
+	// Whatever is left is 1 give or take rounding
+	for ( size_t i = 0; i < large.size(); i++ )
+	{
+		probability[large[i]] = 1.0f;
+		alias[large[i]] = large[i];
+	}
+	for ( size_t i = 0; i < small.size(); i++ )
+	{
+		probability[small[i]] = 1.0f;
+		alias[small[i]] = small[i];
+	}
+	
+	return true;
+}
+
+void ofxParticleAliasTable::clear()
+{
+	probability.clear();
+	alias.clear();
+}
+
+// ------------------------------------------------------------------------
+// Lifecycle
+// ------------------------------------------------------------------------
+
+ofxParticleEmitterShape::ofxParticleEmitterShape()
+{
+	type = kEmitterShapeBox;
+	lineStart = lineEnd = Vector2fZero;
+	radius = innerRadius = 0.0f;
+	
+	maskWidth = 0;
+	maskScale = 1.0f;
+	maskThreshold = 0.0f;
+	maskOrigin = Vector2fZero;
+}
+
+// ------------------------------------------------------------------------
+// Parsing
+// ------------------------------------------------------------------------
+
+void ofxParticleEmitterShape::parse( ofxXmlSettings* settings )
+{
+	type			= settings->getAttribute( "emitterShape", "value", type );
+	
+	lineStart.x		= settings->getAttribute( "emitterShapeLineStart", "x", lineStart.x );
+	lineStart.y		= settings->getAttribute( "emitterShapeLineStart", "y", lineStart.y );
+	lineEnd.x		= settings->getAttribute( "emitterShapeLineEnd", "x", lineEnd.x );
+	lineEnd.y		= settings->getAttribute( "emitterShapeLineEnd", "y", lineEnd.y );
+	
+	radius			= settings->getAttribute( "emitterShapeRadius", "value", radius );
+	innerRadius		= settings->getAttribute( "emitterShapeInnerRadius", "value", innerRadius );
+	
+	int numPoints = settings->getNumTags( "emitterShapePoint" );
+	if ( numPoints > 0 )
+	{
+		std::vector<Vector2f> points( numPoints );
+		for ( int i = 0; i < numPoints; i++ )
+		{
+			points[i].x = ClampFinite( settings->getAttribute( "emitterShapePoint", "x", 0.0, i ), MAXIMUM_CONFIG_VALUE );
+			points[i].y = ClampFinite( settings->getAttribute( "emitterShapePoint", "y", 0.0, i ), MAXIMUM_CONFIG_VALUE );
+		}
+		setPolygon( points );
+	}
+	
+	std::string maskName = settings->getAttribute( "emitterShapeMask", "name", "" );
+	if ( maskName != "" )
+	{
+		GLfloat scale		= ClampFinite( settings->getAttribute( "emitterShapeMask", "scale", 1.0 ), MAXIMUM_CONFIG_VALUE );
+		GLfloat threshold	= ClampFinite( settings->getAttribute( "emitterShapeMask", "threshold", 0.0 ), 1.0f );
+		
+		// Keep the current table when reloading a config that still uses the same mask
+		if ( maskName != maskFilename || scale != maskScale || threshold != maskThreshold || maskTable.empty() )
+			loadMask( maskName, scale, threshold );
+	}
+	
+	if ( type < kEmitterShapeBox || type > kEmitterShapeMask )
+	{
+		ofLog( OF_LOG_WARNING, "ofxParticleEmitterShape::parse() - unknown emitterShape, using the box!" );
+		type = kEmitterShapeBox;
+	}
+	
+	// NaN, infinite or huge values from a broken file would end up in every particle
+	lineStart.x = ClampFinite( lineStart.x, MAXIMUM_CONFIG_VALUE );
+	lineStart.y = ClampFinite( lineStart.y, MAXIMUM_CONFIG_VALUE );
+	lineEnd.x = ClampFinite( lineEnd.x, MAXIMUM_CONFIG_VALUE );
+	lineEnd.y = ClampFinite( lineEnd.y, MAXIMUM_CONFIG_VALUE );
+	
+	// A ring with the radii the wrong way around is still a ring
+	radius = fabsf( ClampFinite( radius, MAXIMUM_CONFIG_VALUE ) );
+	innerRadius = MIN( fabsf( ClampFinite( innerRadius, MAXIMUM_CONFIG_VALUE ) ), radius );
+	
+	if ( ( type == kEmitterShapePolygon && triangleTable.empty() ) ||
+		 ( type == kEmitterShapeMask && maskTable.empty() ) )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitterShape::parse() - shape has no area, falling back to the box!" );
+		type = kEmitterShapeBox;
+	}
+}
+
+// ------------------------------------------------------------------------
+// Polygon
+// ------------------------------------------------------------------------
+
+// Twice the signed area of the triangle abc, positive when counter clockwise
+static inline GLfloat triangleArea2( const Vector2f& a, const Vector2f& b, const Vector2f& c )
+{
+	return ( b.x - a.x ) * ( c.y - a.y ) - ( c.x - a.x ) * ( b.y - a.y );
+}
+
+bool ofxParticleEmitterShape::setPolygon( const std::vector<Vector2f>& points )
+{
+	polygonPoints = points;
+	triangles.clear();
+	triangleTable.clear();
+	
+	int count = (int)points.size();
+	if ( count < 3 )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitterShape::setPolygon() - a polygon needs at least 3 points!" );
+		return false;
+	}
+	
+	// Work counter clockwise whatever the winding of the points
+	GLfloat area = 0.0f;
+	for ( int i = 0; i < count; i++ )
+	{
+		const Vector2f& a = points[i];
+		const Vector2f& b = points[( i + 1 ) % count];
+		area += a.x * b.y - b.x * a.y;
+	}
+	
+	std::vector<int> remaining( count );
+	for ( int i = 0; i < count; i++ )
+		remaining[i] = ( area >= 0.0f ) ? i : count - 1 - i;
+	
+	// Ear clipping, fine for the handful of points a spawn shape has
+	while ( remaining.size() > 3 )
+	{
+		int n = (int)remaining.size();
+		bool clipped = false;
+		
+		for ( int i = 0; i < n && !clipped; i++ )
+		{
+			const Vector2f& a = points[remaining[( i + n - 1 ) % n]];
+			const Vector2f& b = points[remaining[i]];
+			const Vector2f& c = points[remaining[( i + 1 ) % n]];
+			
+			if ( triangleArea2( a, b, c ) <= 0.0f )
+				continue;
+			
+			bool ear = true;
+			for ( int j = 0; j < n && ear; j++ )
+			{
+				if ( j == i || j == ( i + n - 1 ) % n || j == ( i + 1 ) % n )
+					continue;
+				const Vector2f& p = points[remaining[j]];
+				if ( triangleArea2( a, b, p ) >= 0.0f && triangleArea2( b, c, p ) >= 0.0f && triangleArea2( c, a, p ) >= 0.0f )
+					ear = false;
+			}
+			
+			if ( ear )
+			{
+				triangles.push_back( a );
+				triangles.push_back( b );
+				triangles.push_back( c );
+				remaining.erase( remaining.begin() + i );
+				clipped = true;
+			}
+		}
+		
+		// Self intersecting, keep the triangles we have
+		if ( !clipped )
+		{
+			ofLog( OF_LOG_WARNING, "ofxParticleEmitterShape::setPolygon() - polygon is self intersecting, only partly triangulated!" );
+			break;
+		}
+	}
+	
+	if ( remaining.size() == 3 )
+	{
+		triangles.push_back( points[remaining[0]] );
+		triangles.push_back( points[remaining[1]] );
+		triangles.push_back( points[remaining[2]] );
+	}
+	
+	std::vector<GLfloat> weights( triangles.size() / 3 );
+	for ( size_t i = 0; i < weights.size(); i++ )
+		weights[i] = fabsf( triangleArea2( triangles[i * 3], triangles[i * 3 + 1], triangles[i * 3 + 2] ) );
+	
+	if ( !triangleTable.build( weights ) )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitterShape::setPolygon() - polygon has no area!" );
+		return false;
+	}
+	return true;
+}
+
+// ------------------------------------------------------------------------
+// Mask
+// ------------------------------------------------------------------------
+
+bool ofxParticleEmitterShape::loadMask( const std::string& filename, GLfloat scale, GLfloat threshold )
+{
+	maskFilename = filename;
+	maskTable.clear();
+	maskPixels.clear();
+	
+	ofImage image;
+	image.setUseTexture( false );
+	if ( !image.loadImage( filename ) || image.getPixels() == NULL )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitterShape::loadMask() - unable to load " + filename + "!" );
+		return false;
+	}
+	
+	const unsigned char* pixels = image.getPixels();
+	int channels = image.bpp / 8;
+	int numPixels = image.width * image.height;
+	
+	// Only pixels above the threshold go into the table, a mostly empty mask stays small
+	std::vector<GLfloat> weights;
+	for ( int i = 0; i < numPixels; i++ )
+	{
+		const unsigned char* pixel = pixels + i * channels;
+		GLfloat weight;
+		if ( image.type == OF_IMAGE_COLOR_ALPHA )
+			weight = pixel[3] / 255.0f;
+		else if ( image.type == OF_IMAGE_COLOR )
+			weight = ( pixel[0] + pixel[1] + pixel[2] ) / ( 3.0f * 255.0f );
+		else
+			weight = pixel[0] / 255.0f;
+		
+		if ( weight > threshold )
+		{
+			weights.push_back( weight );
+			maskPixels.push_back( i );
+		}
+	}
+	
+	maskWidth = image.width;
+	maskScale = scale;
+	maskThreshold = threshold;
+	maskOrigin = Vector2fMake( -image.width * 0.5f * scale, -image.height * 0.5f * scale );
+	
+	if ( !maskTable.build( weights ) )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitterShape::loadMask() - " + filename + " has no pixels above the threshold!" );
+		maskPixels.clear();
+		return false;
+	}
+	return true;
+}
+
+// ------------------------------------------------------------------------
+// Sampling
+// ------------------------------------------------------------------------
+
+const Vector2f* ofxParticleEmitterShape::sample( int count, GLuint& randomState )
+{
+	if ( count <= 0 )
+		return NULL;
+	
+	if ( (int)offsets.size() < count )
+		offsets.resize( count );
+	Vector2f* out = &offsets[0];
+	
+	// One loop per shape so the switch isn't inside the loop
+	switch ( type )
+	{
+		case kEmitterShapeLine:
+		{
+			Vector2f delta = Vector2fSub( lineEnd, lineStart );
+			for ( int i = 0; i < count; i++ )
+				out[i] = Vector2fAdd( lineStart, Vector2fMultiply( delta, Xorshift32Random0To1( randomState ) ) );
+			break;
+		}
+		case kEmitterShapeCircle:
+		case kEmitterShapeRing:
+		{
+			// Uniform over the area, r^2 is uniform between the inner and outer radius squared
+			GLfloat inner2 = ( type == kEmitterShapeRing ) ? innerRadius * innerRadius : 0.0f;
+			GLfloat range2 = radius * radius - inner2;
+			for ( int i = 0; i < count; i++ )
+			{
+				GLfloat r = sqrtf( inner2 + range2 * Xorshift32Random0To1( randomState ) );
+				GLfloat a = Xorshift32Random0To1( randomState ) * (GLfloat)TWO_PI;
+				out[i] = Vector2fMake( r * cosf( a ), r * sinf( a ) );
+			}
+			break;
+		}
+		case kEmitterShapePolygon:
+		{
+			for ( int i = 0; i < count; i++ )
+			{
+				GLfloat u1 = Xorshift32Random0To1( randomState );
+				GLfloat u2 = Xorshift32Random0To1( randomState );
+				const Vector2f* t = &triangles[triangleTable.sample( u1, u2 ) * 3];
+				
+				// Uniform point in the triangle
+				GLfloat s = sqrtf( Xorshift32Random0To1( randomState ) );
+				GLfloat v = Xorshift32Random0To1( randomState );
+				GLfloat wa = 1.0f - s, wb = s * ( 1.0f - v ), wc = s * v;
+				out[i] = Vector2fMake( t[0].x * wa + t[1].x * wb + t[2].x * wc,
+									   t[0].y * wa + t[1].y * wb + t[2].y * wc );
+			}
+			break;
+		}
+		case kEmitterShapeMask:
+		{
+			for ( int i = 0; i < count; i++ )
+			{
+				GLfloat u1 = Xorshift32Random0To1( randomState );
+				GLfloat u2 = Xorshift32Random0To1( randomState );
+				int pixel = maskPixels[maskTable.sample( u1, u2 )];
+				
+				// Jitter inside the pixel so the spawn doesn't show the grid
+				GLfloat x = ( pixel % maskWidth ) + Xorshift32Random0To1( randomState );
+				GLfloat y = ( pixel / maskWidth ) + Xorshift32Random0To1( randomState );
+				out[i] = Vector2fMake( maskOrigin.x + x * maskScale, maskOrigin.y + y * maskScale );
+			}
+			break;
+		}
+		default:
+		{
+			for ( int i = 0; i < count; i++ )
+				out[i] = Vector2fZero;
+			break;
+		}
+	}
+	
+	return out;
+}
@@ -0,0 +1,127 @@
+//
+// ofxParticleEmitterShape.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_EMITTER_SHAPE
+#define _OFX_PARTICLE_EMITTER_SHAPE
+
+#include "ofMain.h"
+#include "ofxXmlSettings.h"
+#include "ofxParticleEmitter.h"
+
+// Emission shapes, the box is the original sourcePosition +/- sourcePositionVariance
+// spawn and is handled by the emitter itself
+enum kEmitterShapes
+{
+	kEmitterShapeBox,
+	kEmitterShapeLine,
+	kEmitterShapeCircle,
+	kEmitterShapeRing,
+	kEmitterShapePolygon,
+	kEmitterShapeMask
+};
+
+// ------------------------------------------------------------------------
+// ofxParticleAliasTable
+// ------------------------------------------------------------------------
+
+// Vose's alias method, picks an index with a probability proportional to its weight
+// in constant time no matter how many weights there are
+class ofxParticleAliasTable
+{
+	
+public:
+	
+	// Returns false if there are no positive weights
+	bool	build( const std::vector<GLfloat>& weights );
+	void	clear();
+	
+	bool	empty() const { return probability.empty(); }
+	
+	// u1 and u2 are random numbers between 0 and 1
+	inline int	sample( GLfloat u1, GLfloat u2 ) const
+	{
+		int count = (int)probability.size();
+		int index = (int)( u1 * count );
+		if ( index >= count )
+			index = count - 1;
+		return ( u2 < probability[index] ) ? index : alias[index];
+	}
+	
+protected:
+	
+	std::vector<GLfloat>	probability;
+	std::vector<int>		alias;
+};
+
+// ------------------------------------------------------------------------
+// ofxParticleEmitterShape
+// ------------------------------------------------------------------------
+
+// Where particles spawn, relative to the emitters sourcePosition.  The polygon is
+// triangulated and the mask turned into an alias table when they are set, so every
+// shape samples in constant time per particle.
+class ofxParticleEmitterShape
+{
+	
+public:
+	
+	ofxParticleEmitterShape();
+	
+	// Reads the emitterShape* tags, must be called with particleEmitterConfig pushed.
+	// Tags that aren't there leave the current values alone
+	void	parse( ofxXmlSettings* settings );
+	
+	// Polygon points in order, either winding.  Returns false if it can't be triangulated
+	bool	setPolygon( const std::vector<Vector2f>& points );
+	
+	// Spawn where the image has alpha (or brightness for images without alpha) above
+	// threshold, weighted by it.  The image is centered on the source position.  Only
+	// decodes the pixels so it is safe to call from a worker thread
+	bool	loadMask( const std::string& filename, GLfloat scale = 1.0f, GLfloat threshold = 0.0f );
+	
+	// Fill a scratch array with count spawn offsets using randomState, the returned array
+	// is valid until the next call
+	const Vector2f*	sample( int count, GLuint& randomState );
+	
+	int			type;					// One of kEmitterShapes
+	Vector2f	lineStart, lineEnd;		// kEmitterShapeLine
+	GLfloat		radius;					// kEmitterShapeCircle and kEmitterShapeRing
+	GLfloat		innerRadius;			// kEmitterShapeRing
+	
+protected:
+	
+	std::vector<Vector2f>	polygonPoints;
+	std::vector<Vector2f>	triangles;		// Three points per triangle
+	ofxParticleAliasTable	triangleTable;
+	
+	std::string				maskFilename;
+	int						maskWidth;
+	GLfloat					maskScale, maskThreshold;
+	Vector2f				maskOrigin;
+	ofxParticleAliasTable	maskTable;
+	std::vector<int>		maskPixels;		// Pixel index of each alias table entry
+	
+	std::vector<Vector2f>	offsets;
+};
+
+#endif
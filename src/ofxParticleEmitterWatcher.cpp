@@ -0,0 +1,205 @@
+//
+// ofxParticleEmitterWatcher.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticleEmitterWatcher.h"
+
+#include <sys/stat.h>
+
+#ifdef TARGET_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+// Return the modification time of path, or 0 if it can't be read
+static time_t modifiedTime( const std::string& path )
+{
+	struct stat info;
+	if ( stat( path.c_str(), &info ) != 0 )
+		return 0;
+	return info.st_mtime;
+}
+
+// ------------------------------------------------------------------------
+// Lifecycle
+// ------------------------------------------------------------------------
+
+ofxParticleEmitterWatcher::ofxParticleEmitterWatcher()
+{
+	pollIntervalMillis = 250;
+	lastPollMillis = 0;
+	inotifyFd = -1;
+	
+#ifdef TARGET_LINUX
+	inotifyFd = inotify_init();
+	if ( inotifyFd < 0 )
+		ofLog( OF_LOG_WARNING, "ofxParticleEmitterWatcher() - inotify unavailable, falling back to polling" );
+	else
+		fcntl( inotifyFd, F_SETFL, fcntl( inotifyFd, F_GETFL ) | O_NONBLOCK );
+#endif
+}
+
+ofxParticleEmitterWatcher::~ofxParticleEmitterWatcher()
+{
+	exit();
+}
+
+void ofxParticleEmitterWatcher::exit()
+{
+	files.clear();
+	
+#ifdef TARGET_LINUX
+	// Closing the descriptor removes all of its watches
+	if ( inotifyFd >= 0 )
+		close( inotifyFd );
+#endif
+	inotifyFd = -1;
+}
+
+// ------------------------------------------------------------------------
+// Watches
+// ------------------------------------------------------------------------
+
+void ofxParticleEmitterWatcher::watch( ofxParticleEmitter* emitter, const std::string& filename )
+{
+	if ( emitter == NULL )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleEmitterWatcher::watch() - emitter is invalid!" );
+		return;
+	}
+	
+	std::string path = ofToDataPath( filename );
+	size_t slash = path.find_last_of( "/\\" );
+	
+	WatchedFile file;
+	file.emitter = emitter;
+	file.filename = filename;
+	file.directory = ( slash == std::string::npos ) ? "." : path.substr( 0, slash );
+	file.name = ( slash == std::string::npos ) ? path : path.substr( slash + 1 );
+	file.modified = modifiedTime( path );
+	file.watchDescriptor = -1;
+	file.changed = false;
+	
+#ifdef TARGET_LINUX
+	// Watch the directory rather than the file itself, editors that save by writing a
+	// temporary file and renaming it over the original would otherwise lose the watch.
+	// Adding the same directory twice returns the same descriptor
+	if ( inotifyFd >= 0 )
+	{
+		file.watchDescriptor = inotify_add_watch( inotifyFd, file.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO );
+		if ( file.watchDescriptor < 0 )
+			ofLog( OF_LOG_WARNING, "ofxParticleEmitterWatcher::watch() - could not watch " + file.directory );
+	}
+#endif
+	
+	files.push_back( file );
+}
+
+void ofxParticleEmitterWatcher::unwatch( ofxParticleEmitter* emitter )
+{
+	// Directory watches are left in place, they are cheap and may be shared with other files
+	for ( int i = files.size() - 1; i >= 0; i-- )
+	{
+		if ( files[i].emitter == emitter )
+			files.erase( files.begin() + i );
+	}
+}
+
+// ------------------------------------------------------------------------
+// Update
+// ------------------------------------------------------------------------
+
+void ofxParticleEmitterWatcher::update()
+{
+	if ( files.empty() ) return;
+	
+	readEvents();
+	
+	if ( ofGetElapsedTimeMillis() - lastPollMillis >= pollIntervalMillis )
+	{
+		pollModifiedTimes();
+		lastPollMillis = ofGetElapsedTimeMillis();
+	}
+	
+	// Reload each changed file once no matter how many events it produced this frame
+	for ( unsigned int i = 0; i < files.size(); i++ )
+	{
+		if ( !files[i].changed ) continue;
+		files[i].changed = false;
+		
+		int startMillis = ofGetElapsedTimeMillis();
+		if ( files[i].emitter->reloadFromXml( files[i].filename ) )
+		{
+			ofLog( OF_LOG_NOTICE, "ofxParticleEmitterWatcher::update() - reloaded " + files[i].filename +
+				  " in " + ofToString( ofGetElapsedTimeMillis() - startMillis ) + "ms" );
+		}
+		else
+		{
+			// A half written file will usually fail to parse, the next write event retries
+			ofLog( OF_LOG_WARNING, "ofxParticleEmitterWatcher::update() - failed to reload " + files[i].filename );
+		}
+	}
+}
+
+void ofxParticleEmitterWatcher::readEvents()
+{
+#ifdef TARGET_LINUX
+	if ( inotifyFd < 0 ) return;
+	
+	char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	ssize_t length;
+	
+	while ( ( length = read( inotifyFd, buffer, sizeof( buffer ) ) ) > 0 )
+	{
+		for ( char* ptr = buffer; ptr < buffer + length; )
+		{
+			struct inotify_event* event = (struct inotify_event*)ptr;
+			ptr += sizeof( struct inotify_event ) + event->len;
+			
+			if ( event->len == 0 ) continue;
+			
+			for ( unsigned int i = 0; i < files.size(); i++ )
+			{
+				if ( files[i].watchDescriptor == event->wd && files[i].name == event->name )
+					files[i].changed = true;
+			}
+		}
+	}
+#endif
+}
+
+void ofxParticleEmitterWatcher::pollModifiedTimes()
+{
+	for ( unsigned int i = 0; i < files.size(); i++ )
+	{
+		// Files covered by inotify don't need to be polled
+		if ( files[i].watchDescriptor >= 0 ) continue;
+		
+		time_t modified = modifiedTime( files[i].directory + "/" + files[i].name );
+		if ( modified != 0 && modified != files[i].modified )
+		{
+			files[i].modified = modified;
+			files[i].changed = true;
+		}
+	}
+}
@@ -0,0 +1,77 @@
+//
+// ofxParticleEmitterWatcher.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_EMITTER_WATCHER
+#define _OFX_PARTICLE_EMITTER_WATCHER
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+
+#include <sys/types.h>
+
+// ------------------------------------------------------------------------
+// ofxParticleEmitterWatcher
+// ------------------------------------------------------------------------
+
+// Hot-reloads .pex files into live emitters when they change on disk.  On Linux
+// the containing directories are watched with inotify, which also catches editors
+// that save by renaming over the file; elsewhere the modification times are polled
+// every pollIntervalMillis.  update() never blocks and should be called once per
+// frame from the GL thread.
+class ofxParticleEmitterWatcher
+{
+	
+public:
+	
+	ofxParticleEmitterWatcher();
+	~ofxParticleEmitterWatcher();
+	
+	void	watch( ofxParticleEmitter* emitter, const std::string& filename );
+	void	unwatch( ofxParticleEmitter* emitter );
+	void	update();
+	void	exit();
+	
+	int		pollIntervalMillis;
+	
+protected:
+	
+	typedef struct
+	{
+		ofxParticleEmitter*	emitter;
+		std::string			filename;		// As passed to watch(), relative to the data folder
+		std::string			directory;
+		std::string			name;
+		time_t				modified;
+		int					watchDescriptor;
+		bool				changed;
+	} WatchedFile;
+	
+	void	readEvents();
+	void	pollModifiedTimes();
+	
+	std::vector<WatchedFile>	files;
+	int							inotifyFd;
+	int							lastPollMillis;
+};
+
+#endif
@@ -0,0 +1,384 @@
+//
+// ofxParticleGroup.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticleGroup.h"
+
+// A handle is the source's slot in the low bits and the slot's generation above them
+#define SOURCE_INDEX_BITS		20
+#define SOURCE_INDEX_MASK		( ( 1 << SOURCE_INDEX_BITS ) - 1 )
+#define SOURCE_GENERATION_MASK	0x7ff	// Keeps handles positive
+
+// ------------------------------------------------------------------------
+// Lifecycle
+// ------------------------------------------------------------------------
+
+ofxParticleGroup::ofxParticleGroup()
+{
+	config = NULL;
+	
+	maxParticles = 0;
+	particleCount = 0;
+	positionX = positionY = NULL;
+	directionX = directionY = NULL;
+	startX = startY = NULL;
+	red = green = blue = alpha = NULL;
+	deltaRed = deltaGreen = deltaBlue = deltaAlpha = NULL;
+	size = sizeDelta = NULL;
+	timeToLive = NULL;
+	
+	vertices = NULL;
+	numDrawCalls = 0;
+	lastUpdateMillis = 0;
+	randomState = 1;
+}
+
+ofxParticleGroup::~ofxParticleGroup()
+{
+	exit();
+}
+
+// Every field of the pool, in one place so they are allocated and freed together
+#define PARTICLE_GROUP_FIELDS( F ) \
+	F( positionX ) F( positionY ) F( directionX ) F( directionY ) F( startX ) F( startY ) \
+	F( red ) F( green ) F( blue ) F( alpha ) \
+	F( deltaRed ) F( deltaGreen ) F( deltaBlue ) F( deltaAlpha ) \
+	F( size ) F( sizeDelta ) F( timeToLive )
+
+void ofxParticleGroup::setup( ofxParticleEmitter* config, int maxParticles )
+{
+	exit();
+	
+	if ( config == NULL || !config->isLoaded() )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleGroup::setup() - config emitter is not loaded!" );
+		return;
+	}
+	
+	if ( config->emitterType != kParticleTypeGravity )
+		ofLog( OF_LOG_WARNING, "ofxParticleGroup::setup() - only gravity emitters are supported, simulating as gravity!" );
+	
+	this->config = config;
+	this->maxParticles = MAX( 1, maxParticles );
+	
+#define ALLOCATE_FIELD( name ) name = (GLfloat*)malloc( sizeof( GLfloat ) * this->maxParticles );
+	PARTICLE_GROUP_FIELDS( ALLOCATE_FIELD )
+#undef ALLOCATE_FIELD
+	vertices = (PointSprite*)malloc( sizeof( PointSprite ) * this->maxParticles );
+	
+	// Seed from ofRandom so ofSeedRandom() still controls the group
+	randomState = (GLuint)ofRandom( 1.0f, 16777216.0f );
+	lastUpdateMillis = ofGetElapsedTimeMillis();
+}
+
+void ofxParticleGroup::exit()
+{
+#define FREE_FIELD( name ) if ( name != NULL ) free( name ); name = NULL;
+	PARTICLE_GROUP_FIELDS( FREE_FIELD )
+#undef FREE_FIELD
+	
+	if ( vertices != NULL )
+		free( vertices );
+	vertices = NULL;
+	batch.exit();
+	
+	sourceX.clear();
+	sourceY.clear();
+	emitCounter.clear();
+	sourceActive.clear();
+	sourceGeneration.clear();
+	freeSources.clear();
+	
+	config = NULL;
+	maxParticles = 0;
+	particleCount = 0;
+}
+
+// ------------------------------------------------------------------------
+// Sources
+// ------------------------------------------------------------------------
+
+int ofxParticleGroup::addSource( const Vector2f& position, bool active )
+{
+	int index;
+	if ( !freeSources.empty() )
+	{
+		index = freeSources.back();
+		freeSources.pop_back();
+	}
+	else
+	{
+		index = sourceX.size();
+		if ( index > SOURCE_INDEX_MASK )
+		{
+			ofLog( OF_LOG_ERROR, "ofxParticleGroup::addSource() - too many sources!" );
+			return -1;
+		}
+		
+		sourceX.push_back( 0.0f );
+		sourceY.push_back( 0.0f );
+		emitCounter.push_back( 0.0f );
+		sourceActive.push_back( 0 );
+		sourceGeneration.push_back( 0 );
+	}
+	
+	int handle = ( sourceGeneration[index] << SOURCE_INDEX_BITS ) | index;
+	emitCounter[index] = 0.0f;
+	setSource( handle, position, active );
+	return handle;
+}
+
+void ofxParticleGroup::removeSource( int handle )
+{
+	int index = getSourceIndex( handle );
+	if ( index < 0 ) return;
+	
+	sourceActive[index] = 0;
+	sourceGeneration[index] = ( sourceGeneration[index] + 1 ) & SOURCE_GENERATION_MASK;
+	freeSources.push_back( index );
+}
+
+void ofxParticleGroup::setSource( int handle, const Vector2f& position, bool active )
+{
+	int index = getSourceIndex( handle );
+	if ( index < 0 ) return;
+	
+	sourceX[index] = position.x;
+	sourceY[index] = position.y;
+	sourceActive[index] = active ? 1 : 0;
+}
+
+void ofxParticleGroup::updateSources( const ParticleEmitterUpdate* updates, int count )
+{
+	for ( int i = 0; i < count; i++ )
+	{
+		const ParticleEmitterUpdate& update = updates[i];
+		int index = getSourceIndex( update.handle );
+		if ( index < 0 ) continue;
+		
+		sourceX[index] = update.position.x;
+		sourceY[index] = update.position.y;
+		sourceActive[index] = update.active ? 1 : 0;
+	}
+}
+
+// Returns the slot of a live source, or -1 if the handle was never given out or its
+// source has been removed
+int ofxParticleGroup::getSourceIndex( int handle ) const
+{
+	if ( handle < 0 ) return -1;
+	
+	int index = handle & SOURCE_INDEX_MASK;
+	if ( index >= (int)sourceX.size() || sourceGeneration[index] != ( handle >> SOURCE_INDEX_BITS ) )
+		return -1;
+	return index;
+}
+
+// ------------------------------------------------------------------------
+// Update
+// ------------------------------------------------------------------------
+
+void ofxParticleGroup::update()
+{
+	if ( config == NULL ) return;
+	
+	GLfloat aDelta = ( ofGetElapsedTimeMillis() - lastUpdateMillis ) / 1000.0f;
+	
+	simulate( aDelta );
+	
+	lastUpdateMillis = ofGetElapsedTimeMillis();
+}
+
+void ofxParticleGroup::simulate( GLfloat aDelta )
+{
+	// The clock can go backwards, e.g. when it is reset, which would make particles younger
+	aDelta = MAX( 0, aDelta );
+	
+	int i = 0;
+	while ( i < particleCount )
+	{
+		if ( updateParticle( i, aDelta, 1.0f ) )
+		{
+			i++;
+		}
+		else
+		{
+			// Move the last particle into this slot and look at it next
+			removeParticle( i );
+		}
+	}
+	
+	// Emit for every active source at the rate of a single emitter using the config.  As in
+	// ofxParticleEmitter::simulate() the particles due are spawned after the update and each
+	// is aged by the time since it was due, otherwise after a stall they would all be born
+	// dead.  Only the youngest are spawned, up to the longest lifespan worth of them
+	GLfloat rate = config->particleLifespan / config->maxParticles;
+	GLfloat longest = config->particleLifespan + fabsf( config->particleLifespanVariance );
+	GLfloat backlog = ceilf( longest / rate );
+	int numSources = sourceX.size();
+	for ( int s = 0; s < numSources; s++ )
+	{
+		if ( !sourceActive[s] ) continue;
+		
+		GLfloat counter = emitCounter[s] + aDelta;
+		GLfloat due = floorf( counter / rate );
+		emitCounter[s] = fmodf( counter, rate );
+		
+		// A full pool drops what is due rather than building up a backlog for later
+		int emitCount = (int)MIN( due, backlog );
+		emitCount = MIN( emitCount, maxParticles - particleCount );
+		
+		// Oldest first so the pool stays roughly in spawn order
+		for ( int k = emitCount - 1; k >= 0; k-- )
+		{
+			GLfloat age = MIN( aDelta, emitCounter[s] + rate * k );
+			GLfloat updates = aDelta > 0 ? age / aDelta : 0.0f;
+			
+			emit( sourceX[s], sourceY[s] );
+			if ( !updateParticle( particleCount - 1, age, updates ) )
+				removeParticle( particleCount - 1 );
+		}
+	}
+	
+	for ( i = 0; i < particleCount; i++ )
+	{
+		vertices[i].x = positionX[i];
+		vertices[i].y = positionY[i];
+		vertices[i].size = MAX( 0, size[i] );
+		vertices[i].color = Color4fMake( red[i], green[i], blue[i], alpha[i] );
+	}
+}
+
+// Return a random number between -1 and 1 from the groups own random state
+static inline GLfloat randomMinus1To1( GLuint& state )
+{
+	return Xorshift32Random0To1( state ) * 2.0f - 1.0f;
+}
+
+// Same as ofxParticleEmitter::initParticle() for a gravity emitter
+// Same integration as the gravity branch of ofxParticleEmitter::updateParticle(), one field
+// at a time.  The color and size deltas are per update.  Returns false once the particle is dead
+bool ofxParticleGroup::updateParticle( int i, GLfloat aDelta, GLfloat updates )
+{
+	timeToLive[i] -= aDelta;
+	if ( timeToLive[i] <= 0.0f )
+		return false;
+	
+	GLfloat x = positionX[i] - startX[i];
+	GLfloat y = positionY[i] - startY[i];
+	GLfloat radialX = 0.0f, radialY = 0.0f;
+	if ( x || y )
+	{
+		GLfloat inverseLength = 1.0f / sqrtf( x * x + y * y );
+		radialX = x * inverseLength;
+		radialY = y * inverseLength;
+	}
+	
+	GLfloat radialAcceleration = config->radialAcceleration;
+	GLfloat tangentialAcceleration = config->tangentialAcceleration;
+	GLfloat accelerationX = radialX * radialAcceleration - radialY * tangentialAcceleration + config->gravity.x;
+	GLfloat accelerationY = radialY * radialAcceleration + radialX * tangentialAcceleration + config->gravity.y;
+	directionX[i] += accelerationX * aDelta;
+	directionY[i] += accelerationY * aDelta;
+	positionX[i] += directionX[i] * aDelta;
+	positionY[i] += directionY[i] * aDelta;
+	
+	red[i] += deltaRed[i] * updates;
+	green[i] += deltaGreen[i] * updates;
+	blue[i] += deltaBlue[i] * updates;
+	alpha[i] += deltaAlpha[i] * updates;
+	size[i] += sizeDelta[i] * updates;
+	
+	return true;
+}
+
+void ofxParticleGroup::emit( GLfloat x, GLfloat y )
+{
+	const ofxParticleEmitter& c = *config;
+	int i = particleCount++;
+	
+	positionX[i] = x + c.sourcePositionVariance.x * randomMinus1To1( randomState );
+	positionY[i] = y + c.sourcePositionVariance.y * randomMinus1To1( randomState );
+	startX[i] = x;
+	startY[i] = y;
+	
+	GLfloat newAngle = (GLfloat)DEGREES_TO_RADIANS( c.angle + c.angleVariance * randomMinus1To1( randomState ) );
+	GLfloat vectorSpeed = c.speed + c.speedVariance * randomMinus1To1( randomState );
+	directionX[i] = cosf( newAngle ) * vectorSpeed;
+	directionY[i] = sinf( newAngle ) * vectorSpeed;
+	
+	// Clamped separately as MAX would draw the random number twice
+	GLfloat life = c.particleLifespan + c.particleLifespanVariance * randomMinus1To1( randomState );
+	life = MAX( MINIMUM_LIFESPAN, life );
+	timeToLive[i] = life;
+	
+	// The deltas are per update like the emitters, see MAXIMUM_UPDATE_RATE
+	GLfloat perUpdate = 1.0f / ( life * MAXIMUM_UPDATE_RATE );
+	
+	GLfloat startSize = c.startParticleSize + c.startParticleSizeVariance * randomMinus1To1( randomState );
+	GLfloat finishSize = c.finishParticleSize + c.finishParticleSizeVariance * randomMinus1To1( randomState );
+	size[i] = MAX( 0, startSize );
+	sizeDelta[i] = ( finishSize - startSize ) * perUpdate;
+	
+	red[i] = c.startColor.red + c.startColorVariance.red * randomMinus1To1( randomState );
+	green[i] = c.startColor.green + c.startColorVariance.green * randomMinus1To1( randomState );
+	blue[i] = c.startColor.blue + c.startColorVariance.blue * randomMinus1To1( randomState );
+	alpha[i] = c.startColor.alpha + c.startColorVariance.alpha * randomMinus1To1( randomState );
+	
+	deltaRed[i] = ( c.finishColor.red + c.finishColorVariance.red * randomMinus1To1( randomState ) - red[i] ) * perUpdate;
+	deltaGreen[i] = ( c.finishColor.green + c.finishColorVariance.green * randomMinus1To1( randomState ) - green[i] ) * perUpdate;
+	deltaBlue[i] = ( c.finishColor.blue + c.finishColorVariance.blue * randomMinus1To1( randomState ) - blue[i] ) * perUpdate;
+	deltaAlpha[i] = ( c.finishColor.alpha + c.finishColorVariance.alpha * randomMinus1To1( randomState ) - alpha[i] ) * perUpdate;
+}
+
+void ofxParticleGroup::removeParticle( int index )
+{
+	int last = --particleCount;
+	if ( index == last ) return;
+	
+#define MOVE_FIELD( name ) name[index] = name[last];
+	PARTICLE_GROUP_FIELDS( MOVE_FIELD )
+#undef MOVE_FIELD
+}
+
+// ------------------------------------------------------------------------
+// Render
+// ------------------------------------------------------------------------
+
+void ofxParticleGroup::draw( int x, int y )
+{
+	numDrawCalls = 0;
+	if ( config == NULL || config->getTexture() == NULL || particleCount == 0 ) return;
+	
+	// The group draws the config's own texture, not its atlas page
+	AtlasRegion region = { -1, 0.0f, 0.0f, 1.0f, 1.0f };
+	batch.clear();
+	batch.append( vertices, particleCount, region );
+	
+	glPushMatrix();
+	glTranslatef( x, y, 0.0f );
+	
+	ofTextureData textureData = config->getTexture()->getTextureReference().getTextureData();
+	numDrawCalls = batch.draw( textureData, config->blendFuncSource, config->blendFuncDestination );
+	
+	glPopMatrix();
+}
@@ -0,0 +1,109 @@
+//
+// ofxParticleGroup.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_GROUP
+#define _OFX_PARTICLE_GROUP
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+#include "ofxParticleSystem.h"
+
+// ------------------------------------------------------------------------
+// ofxParticleGroup
+// ------------------------------------------------------------------------
+
+// Lots of small emitters sharing one config, one particle pool and one ofxParticleQuadBatch,
+// e.g. a trail per projectile.  That is one draw call for up to 16384 particles, see
+// ofxParticleQuadBatch.  A source is only a position, an active flag and an emit
+// counter, its particles live in a single pool stored as one array per field.  Every
+// source emits at the config's rate as long as the shared pool has room.  Only the
+// gravity emitter type with the box spawn is supported, particles are simulated in
+// world space and drawn in the order they happen to be in the pool.
+class ofxParticleGroup
+{
+	
+public:
+	
+	ofxParticleGroup();
+	~ofxParticleGroup();
+	
+	// The config emitter provides the parameters, texture and blend functions and must
+	// outlive the group.  maxParticles is the size of the pool shared by all sources
+	void	setup( ofxParticleEmitter* config, int maxParticles );
+	void	exit();
+	
+	// Returns a handle, or -1 if there are too many sources.  Slots of removed sources are
+	// reused but their old handles stay dead, so removing twice or moving a removed source
+	// is ignored.  A removed source stops emitting straight away but its particles live out
+	// their lifespan
+	int		addSource( const Vector2f& position, bool active = true );
+	void	removeSource( int handle );
+	
+	// Dead handles are skipped
+	void	setSource( int handle, const Vector2f& position, bool active );
+	void	updateSources( const ParticleEmitterUpdate* updates, int count );
+	
+	void	update();
+	void	draw( int x = 0, int y = 0 );
+	
+	const PointSprite*	getVertices() const { return vertices; }
+	GLint				getParticleCount() const { return particleCount; }
+	int					getNumSources() const { return sourceX.size() - freeSources.size(); }
+	int					getNumDrawCalls() const { return numDrawCalls; }
+	
+protected:
+	
+	int		getSourceIndex( int handle ) const;
+	void	simulate( GLfloat aDelta );
+	bool	updateParticle( int i, GLfloat aDelta, GLfloat updates );
+	void	emit( GLfloat x, GLfloat y );
+	void	removeParticle( int index );
+	
+	ofxParticleEmitter*			config;
+	
+	// Sources, indexed by handle
+	std::vector<GLfloat>		sourceX, sourceY;
+	std::vector<GLfloat>		emitCounter;
+	std::vector<unsigned char>	sourceActive;
+	std::vector<int>			sourceGeneration;	// Bumped on removal, part of the handle
+	std::vector<int>			freeSources;
+	
+	// Particle pool, one array per field
+	GLint						maxParticles;
+	GLint						particleCount;
+	GLfloat						*positionX, *positionY;
+	GLfloat						*directionX, *directionY;
+	GLfloat						*startX, *startY;
+	GLfloat						*red, *green, *blue, *alpha;
+	GLfloat						*deltaRed, *deltaGreen, *deltaBlue, *deltaAlpha;
+	GLfloat						*size, *sizeDelta;
+	GLfloat						*timeToLive;
+	
+	PointSprite*				vertices;
+	ofxParticleQuadBatch		batch;
+	int							numDrawCalls;
+	int							lastUpdateMillis;
+	GLuint						randomState;
+};
+
+#endif
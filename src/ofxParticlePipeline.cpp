@@ -0,0 +1,164 @@
+//
+// ofxParticlePipeline.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticlePipeline.h"
+#include "ofxParticleAtomic.h"
+
+// ------------------------------------------------------------------------
+// Lifecycle
+// ------------------------------------------------------------------------
+
+ofxParticlePipeline::ofxParticlePipeline()
+{
+	emitter = NULL;
+	emitterVertices = NULL;
+	
+	for ( int i = 0; i < 3; i++ )
+	{
+		buffers[i] = NULL;
+		counts[i] = 0;
+		frames[i] = -1;
+	}
+	front = 0;
+	back = 1;
+	middle = 2;
+	
+	running = 0;
+	frameIndex = 0;
+}
+
+ofxParticlePipeline::~ofxParticlePipeline()
+{
+	stop();
+}
+
+bool ofxParticlePipeline::start( ofxParticleEmitter* emitter )
+{
+	stop();
+	
+	if ( emitter == NULL || !emitter->isLoaded() )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticlePipeline::start() - emitter is not loaded!" );
+		return false;
+	}
+	
+	for ( int i = 0; i < 3; i++ )
+	{
+		buffers[i] = (PointSprite*)malloc( sizeof( PointSprite ) * emitter->maxParticles );
+		counts[i] = 0;
+		frames[i] = -1;
+	}
+	front = 0;
+	back = 1;
+	middle = 2;
+	frameIndex = 0;
+	
+	// The worker simulates straight into the back buffer
+	this->emitter = emitter;
+	emitterVertices = emitter->swapVertices( buffers[back] );
+	
+	running = 1;
+	frameRequested.set();
+	thread.start( *this );
+	
+	return true;
+}
+
+void ofxParticlePipeline::stop()
+{
+	if ( emitter == NULL )
+		return;
+	
+	ofxParticleAtomicStore( &running, 0 );
+	frameRequested.set();
+	thread.join();
+	
+	emitter->swapVertices( emitterVertices );
+	emitter = NULL;
+	emitterVertices = NULL;
+	
+	for ( int i = 0; i < 3; i++ )
+	{
+		free( buffers[i] );
+		buffers[i] = NULL;
+		counts[i] = 0;
+		frames[i] = -1;
+	}
+}
+
+// ------------------------------------------------------------------------
+// Update
+// ------------------------------------------------------------------------
+
+bool ofxParticlePipeline::update()
+{
+	if ( emitter == NULL )
+		return false;
+	
+	bool fresh = false;
+	if ( ofxParticleAtomicLoad( &middle ) & kFreshBit )
+	{
+		// Trade the front buffer for the newest one, the worker only ever swaps a
+		// fresh buffer in so this can't take back a buffer we already drew
+		front = ofxParticleAtomicExchange( &middle, front ) & kIndexMask;
+		fresh = true;
+	}
+	
+	frameRequested.set();
+	return fresh;
+}
+
+void ofxParticlePipeline::run()
+{
+	while ( true )
+	{
+		frameRequested.wait();
+		if ( !ofxParticleAtomicLoad( &running ) )
+			break;
+		
+		// update() does nothing once the emitter has stopped and the back buffer then holds
+		// an old frame, or nothing at all if it was stopped from the start.  Publish an empty
+		// frame instead so the GL thread never draws it
+		bool simulated = emitter->isActive();
+		emitter->update();
+		counts[back] = simulated ? emitter->getParticleCount() : 0;
+		frames[back] = frameIndex++;
+		
+		// Publish the back buffer, if the GL thread hasn't taken the previous frame
+		// it is simply overwritten by this one
+		back = ofxParticleAtomicExchange( &middle, back | kFreshBit ) & kIndexMask;
+		emitter->swapVertices( buffers[back] );
+	}
+}
+
+// ------------------------------------------------------------------------
+// Render
+// ------------------------------------------------------------------------
+
+void ofxParticlePipeline::draw( int x, int y )
+{
+	if ( emitter == NULL || frames[front] < 0 )
+		return;
+	
+	emitter->drawSprites( buffers[front], counts[front], x, y );
+}
@@ -0,0 +1,92 @@
+//
+// ofxParticlePipeline.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_PIPELINE
+#define _OFX_PARTICLE_PIPELINE
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Event.h"
+
+// ------------------------------------------------------------------------
+// ofxParticlePipeline
+// ------------------------------------------------------------------------
+
+// Runs an emitter's simulation on a worker thread so frame N+1 is simulated while
+// frame N is drawn.  The emitter generates its vertices straight into one of three
+// sprite buffers.  Finished buffers are handed over through a single atomic index,
+// the newest frame wins and neither thread ever waits for the other.  Frames published
+// while the emitter is stopped are empty.
+//
+// While the pipeline is running the emitter belongs to the worker, so don't update,
+// draw or reload it and only change its parameters while stopped.
+class ofxParticlePipeline : public Poco::Runnable
+{
+	
+public:
+	
+	ofxParticlePipeline();
+	~ofxParticlePipeline();
+	
+	// The emitter has to be loaded
+	bool	start( ofxParticleEmitter* emitter );
+	void	stop();
+	bool	isRunning() const { return emitter != NULL; }
+	
+	// Call once per frame from the GL thread.  Picks up the newest finished frame, if
+	// there is one, and asks the worker to simulate the next.  Returns true if the
+	// frame changed
+	bool	update();
+	void	draw( int x = 0, int y = 0 );
+	
+	// The frame picked up by the last update()
+	const PointSprite*	getVertices() const { return buffers[front]; }
+	int					getParticleCount() const { return counts[front]; }
+	int					getFrame() const { return frames[front]; }	// -1 before the first frame
+	
+	void	run();
+	
+protected:
+	
+	enum { kFreshBit = 4, kIndexMask = 3 };
+	
+	ofxParticleEmitter*	emitter;
+	PointSprite*		emitterVertices;	// The emitters own array, given back on stop()
+	
+	PointSprite*		buffers[3];
+	int					counts[3];
+	int					frames[3];
+	int					front;				// Only used by the GL thread
+	int					back;				// Only used by the worker
+	volatile int		middle;				// Index of the buffer between them plus kFreshBit
+	
+	Poco::Thread		thread;
+	Poco::Event			frameRequested;
+	volatile int		running;
+	int					frameIndex;
+};
+
+#endif
@@ -0,0 +1,374 @@
+//
+// ofxParticleRecorder.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticleRecorder.h"
+#include "ofxParticleAtomic.h"
+
+#include "Poco/DeflatingStream.h"
+#include "Poco/InflatingStream.h"
+#include "Poco/Exception.h"
+
+// ------------------------------------------------------------------------
+// File format
+// ------------------------------------------------------------------------
+
+// Header at the start of a recording
+typedef struct
+{
+	char		magic[4];
+	GLuint		version;
+	GLuint		spriteSize;
+} ParticleRecordFileHeader;
+
+// Header before each frame, followed by compressedSize bytes of deflated sprites
+typedef struct
+{
+	char					magic[4];
+	GLint					frame;
+	GLint					particleCount;
+	GLuint					compressedSize;
+	ParticleRecordParams	params;
+} ParticleRecordFrameHeader;
+
+static const char	kParticleRecordMagic[4] = { 'O', 'P', 'E', 'R' };
+static const char	kParticleRecordFrameMagic[4] = { 'F', 'R', 'M', 'E' };
+static const GLuint	kParticleRecordVersion = 1;
+
+// Floats next to each other share their sign and exponent bytes, so deflate does much
+// better on the sprites when each byte of the struct is stored as its own plane
+static void shuffleSprites( const PointSprite* sprites, int count, unsigned char* planes )
+{
+	const unsigned char* src = (const unsigned char*)sprites;
+	for ( unsigned int b = 0; b < sizeof( PointSprite ); b++ )
+	{
+		unsigned char* plane = planes + b * count;
+		for ( int i = 0; i < count; i++ )
+			plane[i] = src[i * sizeof( PointSprite ) + b];
+	}
+}
+
+static void unshuffleSprites( const unsigned char* planes, int count, PointSprite* sprites )
+{
+	unsigned char* dst = (unsigned char*)sprites;
+	for ( unsigned int b = 0; b < sizeof( PointSprite ); b++ )
+	{
+		const unsigned char* plane = planes + b * count;
+		for ( int i = 0; i < count; i++ )
+			dst[i * sizeof( PointSprite ) + b] = plane[i];
+	}
+}
+
+// ------------------------------------------------------------------------
+// ofxParticleRecorder
+// ------------------------------------------------------------------------
+
+ofxParticleRecorder::ofxParticleRecorder()
+{
+	recording = false;
+	slots = NULL;
+	numSlots = 0;
+	maxParticles = 0;
+	head = tail = 0;
+	running = 0;
+	frameIndex = 0;
+	numDroppedFrames = 0;
+	shuffled = NULL;
+}
+
+ofxParticleRecorder::~ofxParticleRecorder()
+{
+	stop();
+}
+
+bool ofxParticleRecorder::start( const std::string& filename, int maxParticles, int numSlots /* = 8 */ )
+{
+	stop();
+	
+	if ( maxParticles <= 0 || numSlots <= 0 )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleRecorder::start() - invalid maxParticles or numSlots!" );
+		return false;
+	}
+	
+	file.open( ofToDataPath( filename ).c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if ( !file.is_open() )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleRecorder::start() - could not open " + filename );
+		return false;
+	}
+	
+	ParticleRecordFileHeader header;
+	memcpy( header.magic, kParticleRecordMagic, sizeof( header.magic ) );
+	header.version = kParticleRecordVersion;
+	header.spriteSize = sizeof( PointSprite );
+	file.write( (const char*)&header, sizeof( header ) );
+	
+	// Everything is allocated up front so record() never has to
+	this->maxParticles = maxParticles;
+	this->numSlots = numSlots;
+	slots = new Slot[numSlots];
+	for ( int i = 0; i < numSlots; i++ )
+	{
+		slots[i].sprites = (PointSprite*)malloc( sizeof( PointSprite ) * maxParticles );
+		assert( slots[i].sprites );
+	}
+	shuffled = (unsigned char*)malloc( sizeof( PointSprite ) * maxParticles );
+	assert( shuffled );
+	
+	head = tail = 0;
+	frameIndex = 0;
+	numDroppedFrames = 0;
+	
+	running = 1;
+	recording = true;
+	thread.start( *this );
+	
+	return true;
+}
+
+void ofxParticleRecorder::stop()
+{
+	if ( !recording ) return;
+	
+	// The writer drains whatever is left in the ring before it exits
+	ofxParticleAtomicStore( &running, 0 );
+	wakeEvent.set();
+	thread.join();
+	
+	file.close();
+	recording = false;
+	
+	for ( int i = 0; i < numSlots; i++ )
+		free( slots[i].sprites );
+	delete [] slots;
+	slots = NULL;
+	numSlots = 0;
+	
+	free( shuffled );
+	shuffled = NULL;
+}
+
+void ofxParticleRecorder::record( const ofxParticleEmitter& emitter )
+{
+	if ( !recording ) return;
+	
+	int frame = frameIndex++;
+	
+	// Drop the frame if the writer hasn't freed a slot yet
+	if ( head - ofxParticleAtomicLoad( &tail ) >= numSlots )
+	{
+		numDroppedFrames++;
+		return;
+	}
+	
+	Slot& slot = slots[head % numSlots];
+	slot.frame = frame;
+	slot.particleCount = MIN( emitter.getParticleCount(), maxParticles );
+	slot.params.sourcePosition = emitter.sourcePosition;
+	slot.params.gravity = emitter.gravity;
+	slot.params.angle = emitter.angle;
+	slot.params.speed = emitter.speed;
+	memcpy( slot.sprites, emitter.getVertices(), sizeof( PointSprite ) * slot.particleCount );
+	
+	// Publish the slot to the writer
+	ofxParticleAtomicStore( &head, head + 1 );
+	wakeEvent.set();
+}
+
+void ofxParticleRecorder::run()
+{
+	while ( true )
+	{
+		int current = tail;
+		if ( current == ofxParticleAtomicLoad( &head ) )
+		{
+			if ( !ofxParticleAtomicLoad( &running ) && current == ofxParticleAtomicLoad( &head ) )
+				break;
+			
+			// The event is auto reset and stays set if it was set since the checks above
+			wakeEvent.wait();
+			continue;
+		}
+		
+		writeSlot( slots[current % numSlots] );
+		ofxParticleAtomicStore( &tail, current + 1 );
+	}
+	
+	file.flush();
+}
+
+void ofxParticleRecorder::writeSlot( const Slot& slot )
+{
+	shuffleSprites( slot.sprites, slot.particleCount, shuffled );
+	
+	std::ostringstream compressed;
+	Poco::DeflatingOutputStream deflater( compressed, Poco::DeflatingStreamBuf::STREAM_ZLIB, 1 );
+	deflater.write( (const char*)shuffled, sizeof( PointSprite ) * slot.particleCount );
+	deflater.close();
+	
+	std::string data = compressed.str();
+	
+	ParticleRecordFrameHeader header;
+	memcpy( header.magic, kParticleRecordFrameMagic, sizeof( header.magic ) );
+	header.frame = slot.frame;
+	header.particleCount = slot.particleCount;
+	header.compressedSize = data.size();
+	header.params = slot.params;
+	
+	file.write( (const char*)&header, sizeof( header ) );
+	file.write( data.data(), data.size() );
+}
+
+// ------------------------------------------------------------------------
+// ofxParticlePlayer
+// ------------------------------------------------------------------------
+
+ofxParticlePlayer::ofxParticlePlayer()
+{
+	currentFrame = recordedFrame = -1;
+	particleCount = 0;
+	memset( &params, 0, sizeof( params ) );
+}
+
+ofxParticlePlayer::~ofxParticlePlayer()
+{
+	close();
+}
+
+bool ofxParticlePlayer::open( const std::string& filename )
+{
+	close();
+	
+	file.open( ofToDataPath( filename ).c_str(), std::ios::in | std::ios::binary );
+	if ( !file.is_open() )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticlePlayer::open() - could not open " + filename );
+		return false;
+	}
+	
+	ParticleRecordFileHeader header;
+	file.read( (char*)&header, sizeof( header ) );
+	if ( !file.good() || memcmp( header.magic, kParticleRecordMagic, sizeof( header.magic ) ) != 0 ||
+		header.version != kParticleRecordVersion || header.spriteSize != sizeof( PointSprite ) )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticlePlayer::open() - not a recording or from another version!" );
+		close();
+		return false;
+	}
+	
+	// Find where each frame starts, stopping at the first incomplete one
+	file.seekg( 0, std::ios::end );
+	std::streamoff end = file.tellg();
+	std::streamoff offset = sizeof( header );
+	
+	while ( offset + (std::streamoff)sizeof( ParticleRecordFrameHeader ) <= end )
+	{
+		ParticleRecordFrameHeader frame;
+		file.seekg( offset );
+		file.read( (char*)&frame, sizeof( frame ) );
+		if ( !file.good() || memcmp( frame.magic, kParticleRecordFrameMagic, sizeof( frame.magic ) ) != 0 )
+			break;
+		
+		std::streamoff next = offset + sizeof( frame ) + frame.compressedSize;
+		if ( next > end )
+			break;
+		
+		offsets.push_back( offset );
+		offset = next;
+	}
+	
+	file.clear();
+	return true;
+}
+
+void ofxParticlePlayer::close()
+{
+	if ( file.is_open() )
+		file.close();
+	file.clear();
+	
+	offsets.clear();
+	currentFrame = recordedFrame = -1;
+	particleCount = 0;
+}
+
+bool ofxParticlePlayer::seek( int frame )
+{
+	if ( frame < 0 || frame >= (int)offsets.size() )
+		return false;
+	
+	ParticleRecordFrameHeader header;
+	file.seekg( offsets[frame] );
+	file.read( (char*)&header, sizeof( header ) );
+	
+	std::string data( header.compressedSize, '\0' );
+	if ( header.compressedSize > 0 )
+		file.read( &data[0], header.compressedSize );
+	if ( !file.good() || header.particleCount < 0 )
+	{
+		file.clear();
+		ofLog( OF_LOG_ERROR, "ofxParticlePlayer::seek() - could not read frame " + ofToString( frame ) );
+		return false;
+	}
+	
+	size_t bytes = sizeof( PointSprite ) * header.particleCount;
+	shuffled.resize( bytes );
+	sprites.resize( header.particleCount );
+	
+	if ( bytes > 0 )
+	{
+		// Poco throws on damaged data, a short read means the data was cut off
+		size_t read = 0;
+		try
+		{
+			std::istringstream compressed( data );
+			Poco::InflatingInputStream inflater( compressed, Poco::InflatingStreamBuf::STREAM_ZLIB );
+			inflater.read( (char*)&shuffled[0], bytes );
+			read = inflater.gcount();
+		}
+		catch ( Poco::Exception& )
+		{
+			read = 0;
+		}
+		
+		if ( read != bytes )
+		{
+			ofLog( OF_LOG_ERROR, "ofxParticlePlayer::seek() - frame " + ofToString( frame ) + " is corrupt" );
+			return false;
+		}
+		unshuffleSprites( &shuffled[0], header.particleCount, &sprites[0] );
+	}
+	
+	particleCount = header.particleCount;
+	params = header.params;
+	currentFrame = frame;
+	recordedFrame = header.frame;
+	
+	return true;
+}
+
+void ofxParticlePlayer::draw( ofxParticleEmitter& emitter, int x /* = 0 */, int y /* = 0 */ )
+{
+	if ( particleCount > 0 )
+		emitter.drawSprites( &sprites[0], particleCount, x, y );
+}
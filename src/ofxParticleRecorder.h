@@ -0,0 +1,151 @@
+//
+// ofxParticleRecorder.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_RECORDER
+#define _OFX_PARTICLE_RECORDER
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Event.h"
+
+#include <fstream>
+
+// ------------------------------------------------------------------------
+// Structures
+// ------------------------------------------------------------------------
+
+// Structure that holds the emitter parameters recorded with each frame
+typedef struct
+{
+	Vector2f	sourcePosition;
+	Vector2f	gravity;
+	GLfloat		angle;
+	GLfloat		speed;
+} ParticleRecordParams;
+
+// ------------------------------------------------------------------------
+// ofxParticleRecorder
+// ------------------------------------------------------------------------
+
+// Streams the sprites and parameters of an emitter to an append-only file, one
+// deflated frame at a time.  record() copies the frame into a fixed ring of slots
+// and returns, compression and disk writes happen on a background thread.  When
+// the writer falls behind and the ring is full the frame is dropped rather than
+// blocking the update thread.
+class ofxParticleRecorder : public Poco::Runnable
+{
+	
+public:
+	
+	ofxParticleRecorder();
+	~ofxParticleRecorder();
+	
+	// Frames with more particles than maxParticles are truncated
+	bool	start( const std::string& filename, int maxParticles, int numSlots = 8 );
+	void	record( const ofxParticleEmitter& emitter );
+	void	stop();
+	
+	bool	isRecording() const { return recording; }
+	int		getNumRecordedFrames() const { return frameIndex - numDroppedFrames; }
+	int		getNumDroppedFrames() const { return numDroppedFrames; }
+	
+	void	run();
+	
+protected:
+	
+	typedef struct
+	{
+		GLint					frame;
+		GLint					particleCount;
+		ParticleRecordParams	params;
+		PointSprite*			sprites;
+	} Slot;
+	
+	void	writeSlot( const Slot& slot );
+	
+	std::ofstream	file;
+	Poco::Thread	thread;
+	Poco::Event		wakeEvent;		// Set when a slot is published or recording stops
+	bool			recording;
+	
+	Slot*			slots;
+	int				numSlots;
+	int				maxParticles;
+	volatile int	head;			// Next slot record() fills, only written by the update thread
+	volatile int	tail;			// Next slot to write, only written by the writer thread
+	volatile int	running;
+	
+	int				frameIndex;
+	int				numDroppedFrames;
+	unsigned char*	shuffled;		// Byte planes of a frame, used by the writer thread only
+};
+
+// ------------------------------------------------------------------------
+// ofxParticlePlayer
+// ------------------------------------------------------------------------
+
+// Plays back a file written by ofxParticleRecorder.  Frames can be read in any
+// order and are drawn with an emitter's texture and blend functions, nothing is
+// simulated.
+class ofxParticlePlayer
+{
+	
+public:
+	
+	ofxParticlePlayer();
+	~ofxParticlePlayer();
+	
+	// Indexes every complete frame in the file, so a file still being recorded can be opened
+	bool	open( const std::string& filename );
+	void	close();
+	
+	int		getNumFrames() const { return offsets.size(); }
+	int		getCurrentFrame() const { return currentFrame; }
+	bool	seek( int frame );
+	
+	// The number record() gave the current frame, it skips any frames the recorder dropped
+	int		getRecordedFrame() const { return recordedFrame; }
+	
+	const PointSprite*			getVertices() const { return sprites.empty() ? NULL : &sprites[0]; }
+	int							getParticleCount() const { return particleCount; }
+	const ParticleRecordParams&	getParams() const { return params; }
+	
+	void	draw( ofxParticleEmitter& emitter, int x = 0, int y = 0 );
+	
+protected:
+	
+	std::ifstream				file;
+	std::vector<std::streamoff>	offsets;
+	
+	std::vector<PointSprite>	sprites;
+	std::vector<unsigned char>	shuffled;
+	ParticleRecordParams		params;
+	int							currentFrame;
+	int							recordedFrame;
+	int							particleCount;
+};
+
+#endif
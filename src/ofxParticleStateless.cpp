@@ -0,0 +1,354 @@
+//
+// ofxParticleStateless.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticleStateless.h"
+
+// ------------------------------------------------------------------------
+// Evaluation
+// ------------------------------------------------------------------------
+
+// Integer hash used to derive the random values of a slot, see
+// http://burtleburtle.net/bob/hash/integer.html
+static inline GLuint hashUint( GLuint x )
+{
+	x ^= x >> 16;
+	x *= 0x7feb352dU;
+	x ^= x >> 15;
+	x *= 0x846ca68bU;
+	x ^= x >> 16;
+	return x;
+}
+
+// Next random number between -1 and 1 from a particle's xorshift32 stream.  The stream
+// is seeded from a hash of the slot and spawn, so only one hash is needed per particle
+static inline GLfloat nextMinus1To1( GLuint& state )
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return ( state >> 8 ) * ( 2.0f / 16777216.0f ) - 1.0f;
+}
+
+// Sine and cosine of an angle in radians.  The libm calls keep the position loops from
+// being vectorized and were half the cost of an evaluation.  The angle is brought within
+// half a turn of 0 and the Taylor series used from there, which is good to about 1e-6.
+// There are no comparisons as the compiler turns those back into branches
+static inline void sinCos( GLfloat radians, GLfloat& sine, GLfloat& cosine )
+{
+	// Adding and removing 1.5 * 2^23 rounds to the nearest whole turn, as a float that
+	// large has no fractional bits
+	GLfloat turns = radians * (GLfloat)( 0.5 / PI );
+	turns -= ( turns + 12582912.0f ) - 12582912.0f;
+	
+	GLfloat x = turns * (GLfloat)( 2.0 * PI );
+	GLfloat x2 = x * x;
+	sine = x * ( 1.0f + x2 * ( -1.0f / 6.0f + x2 * ( 1.0f / 120.0f + x2 * ( -1.0f / 5040.0f +
+		x2 * ( 1.0f / 362880.0f + x2 * ( -1.0f / 39916800.0f + x2 * ( 1.0f / 6227020800.0f +
+		x2 * ( -1.0f / 1307674368000.0f + x2 * ( 1.0f / 355687428096000.0f ) ) ) ) ) ) ) ) );
+	cosine = 1.0f + x2 * ( -0.5f + x2 * ( 1.0f / 24.0f + x2 * ( -1.0f / 720.0f +
+		x2 * ( 1.0f / 40320.0f + x2 * ( -1.0f / 3628800.0f + x2 * ( 1.0f / 479001600.0f +
+		x2 * ( -1.0f / 87178291200.0f + x2 * ( 1.0f / 20922789888000.0f +
+		x2 * ( -1.0f / 6402373705728000.0f ) ) ) ) ) ) ) ) );
+}
+
+void ofxParticleStatelessConfigure( ParticleStatelessConfig& config, const ofxParticleEmitter& emitter, int numSlots, GLuint seed )
+{
+	config.emitterType = emitter.emitterType;
+	config.sourcePosition = emitter.sourcePosition;
+	config.sourcePositionVariance = emitter.sourcePositionVariance;
+	config.angle = emitter.angle;
+	config.angleVariance = emitter.angleVariance;
+	config.speed = emitter.speed;
+	config.speedVariance = emitter.speedVariance;
+	config.gravity = emitter.gravity;
+	config.particleLifespan = emitter.particleLifespan;
+	config.particleLifespanVariance = emitter.particleLifespanVariance;
+	config.startColor = emitter.startColor;
+	config.startColorVariance = emitter.startColorVariance;
+	config.finishColor = emitter.finishColor;
+	config.finishColorVariance = emitter.finishColorVariance;
+	config.startParticleSize = emitter.startParticleSize;
+	config.startParticleSizeVariance = emitter.startParticleSizeVariance;
+	config.finishParticleSize = emitter.finishParticleSize;
+	config.finishParticleSizeVariance = emitter.finishParticleSizeVariance;
+	config.maxRadius = emitter.maxRadius;
+	config.maxRadiusVariance = emitter.maxRadiusVariance;
+	config.minRadius = emitter.minRadius;
+	config.rotatePerSecond = emitter.rotatePerSecond;
+	config.rotatePerSecondVariance = emitter.rotatePerSecondVariance;
+	config.updatesPerSecond = ofGetFrameRate() > 0 ? ofGetFrameRate() : 60.0f;
+	config.numSlots = numSlots;
+	config.seed = seed;
+}
+
+// Slots are evaluated a block at a time in stages.  Each stage is a branchless loop over the
+// block that the compiler can vectorize, liveness is kept as a mask and the live particles
+// are packed into the output at the end.  The stages write straight into sprites so the
+// packing copies whole sprites rather than gathering seven arrays
+#define STATELESS_BLOCK_SIZE	256
+
+typedef struct
+{
+	GLuint	random[STATELESS_BLOCK_SIZE];	// Each slot's random stream, carried between stages
+	GLfloat	age[STATELESS_BLOCK_SIZE];
+	GLfloat	t[STATELESS_BLOCK_SIZE];		// How far the color and size have gone from start to finish
+	GLint	alive[STATELESS_BLOCK_SIZE];
+	PointSprite	sprite[STATELESS_BLOCK_SIZE];
+} StatelessBlock;
+
+static int evaluateBlock( const ParticleStatelessConfig& config, GLfloat time, int first, int count, StatelessBlock& block, PointSprite* out )
+{
+	// Each slot respawns once per cycle, a cycle being the longest a particle can live.  This
+	// matches the stateful emitter once its pool is full.  The slots are staggered evenly
+	// across the cycle so the emission rate is constant
+	GLfloat cycle = MAX( 0.001f, config.particleLifespan + fabsf( config.particleLifespanVariance ) );
+	GLfloat inverseCycle = 1.0f / cycle;
+	GLfloat stagger = cycle / MAX( 1, config.numSlots );
+	GLfloat degreesToRadians = (GLfloat)( PI / 180.0 );
+	
+	// update() applies the color, size and radius deltas once per update, each being a
+	// 1 / MAXIMUM_UPDATE_RATE share of the lifespan's worth, see ofxParticleEmitter::initParticle()
+	GLfloat updatesPerSecond = MAX( 1.0f, config.updatesPerSecond );
+	GLfloat updateScale = updatesPerSecond / MAXIMUM_UPDATE_RATE;
+	GLfloat radiusRate = config.particleLifespan > 0 ? config.maxRadius / config.particleLifespan * updateScale : 0.0f;
+	GLfloat updateSeconds = 1.0f / updatesPerSecond;
+	
+	// Age and lifespan.  Slots that haven't spawned yet are evaluated at age 0 and masked out
+	for ( int j = 0; j < count; j++ )
+	{
+		GLfloat local = time - ( first + j ) * stagger;
+		GLint started = local >= 0;
+		local = MAX( 0, local );
+		
+		GLint spawn = (GLint)( local * inverseCycle );
+		GLfloat age = local - spawn * cycle;
+		GLuint random = hashUint( config.seed ^ hashUint( (GLuint)( first + j ) * 0x9e3779b9U + (GLuint)spawn ) ) | 1;
+		
+		// MIN and MAX evaluate their arguments more than once, so draw first and clamp after
+		GLfloat life = config.particleLifespan + config.particleLifespanVariance * nextMinus1To1( random );
+		life = MAX( MINIMUM_LIFESPAN, life );
+		life = MIN( cycle, life );
+		
+		block.random[j] = random;
+		block.age[j] = age;
+		block.t[j] = age * updateScale / life;
+		block.alive[j] = started & ( age < life );
+	}
+	
+	// Position, the emitter type is the same for the whole block so it is tested outside the loops
+	if ( config.emitterType == kParticleTypeRadial )
+	{
+		for ( int j = 0; j < count; j++ )
+		{
+			GLuint random = block.random[j];
+			GLfloat radius = config.maxRadius + config.maxRadiusVariance * nextMinus1To1( random ) - radiusRate * block.age[j];
+			GLfloat startAngle = ( config.angle + config.angleVariance * nextMinus1To1( random ) ) * degreesToRadians;
+			GLfloat degreesPerSecond = ( config.rotatePerSecond + config.rotatePerSecondVariance * nextMinus1To1( random ) ) * degreesToRadians;
+			GLfloat sine, cosine;
+			sinCos( startAngle + degreesPerSecond * block.age[j], sine, cosine );
+			
+			block.sprite[j].x = config.sourcePosition.x - cosine * radius;
+			block.sprite[j].y = config.sourcePosition.y - sine * radius;
+			block.alive[j] &= radius >= config.minRadius;
+			block.random[j] = random;
+		}
+	}
+	else
+	{
+		for ( int j = 0; j < count; j++ )
+		{
+			GLuint random = block.random[j];
+			GLfloat angle = ( config.angle + config.angleVariance * nextMinus1To1( random ) ) * degreesToRadians;
+			GLfloat speed = config.speed + config.speedVariance * nextMinus1To1( random );
+			GLfloat x = config.sourcePosition.x + config.sourcePositionVariance.x * nextMinus1To1( random );
+			GLfloat y = config.sourcePosition.y + config.sourcePositionVariance.y * nextMinus1To1( random );
+			
+			// update() adds gravity to the velocity before moving, so after n updates of dt
+			// p = p0 + v0 * t + g * ( t^2 + t * dt ) / 2 rather than the exact g * t^2 / 2
+			GLfloat age = block.age[j];
+			GLfloat fall = 0.5f * age * ( age + updateSeconds );
+			GLfloat sine, cosine;
+			sinCos( angle, sine, cosine );
+			block.sprite[j].x = x + cosine * speed * age + config.gravity.x * fall;
+			block.sprite[j].y = y + sine * speed * age + config.gravity.y * fall;
+			block.random[j] = random;
+		}
+	}
+	
+	// Size and color, t is how far the per update deltas have taken them
+	for ( int j = 0; j < count; j++ )
+	{
+		GLuint random = block.random[j];
+		GLfloat t = block.t[j];
+		
+		GLfloat startSize = config.startParticleSize + config.startParticleSizeVariance * nextMinus1To1( random );
+		GLfloat finishSize = config.finishParticleSize + config.finishParticleSizeVariance * nextMinus1To1( random );
+		GLfloat size = MAX( 0, startSize ) + ( finishSize - startSize ) * t;
+		block.sprite[j].size = MAX( 0, size );
+		
+		GLfloat startRed = config.startColor.red + config.startColorVariance.red * nextMinus1To1( random );
+		GLfloat startGreen = config.startColor.green + config.startColorVariance.green * nextMinus1To1( random );
+		GLfloat startBlue = config.startColor.blue + config.startColorVariance.blue * nextMinus1To1( random );
+		GLfloat startAlpha = config.startColor.alpha + config.startColorVariance.alpha * nextMinus1To1( random );
+		GLfloat endRed = config.finishColor.red + config.finishColorVariance.red * nextMinus1To1( random );
+		GLfloat endGreen = config.finishColor.green + config.finishColorVariance.green * nextMinus1To1( random );
+		GLfloat endBlue = config.finishColor.blue + config.finishColorVariance.blue * nextMinus1To1( random );
+		GLfloat endAlpha = config.finishColor.alpha + config.finishColorVariance.alpha * nextMinus1To1( random );
+		
+		block.sprite[j].color.red = startRed + ( endRed - startRed ) * t;
+		block.sprite[j].color.green = startGreen + ( endGreen - startGreen ) * t;
+		block.sprite[j].color.blue = startBlue + ( endBlue - startBlue ) * t;
+		block.sprite[j].color.alpha = startAlpha + ( endAlpha - startAlpha ) * t;
+	}
+	
+	// Pack the live particles.  Every slot is copied and the output only advances past live
+	// ones, so there is no branch on the mask
+	int live = 0;
+	for ( int j = 0; j < count; j++ )
+	{
+		out[live] = block.sprite[j];
+		live += block.alive[j];
+	}
+	
+	return live;
+}
+
+int ofxParticleStatelessEvaluate( const ParticleStatelessConfig& config, GLfloat time, int first, int last, PointSprite* out )
+{
+	StatelessBlock block;
+	
+	int count = 0;
+	for ( int i = first; i < last; i += STATELESS_BLOCK_SIZE )
+		count += evaluateBlock( config, time, i, MIN( STATELESS_BLOCK_SIZE, last - i ), block, &out[count] );
+	
+	return count;
+}
+
+// ------------------------------------------------------------------------
+// ofxParticleStatelessEmitter
+// ------------------------------------------------------------------------
+
+ofxParticleStatelessEmitter::ofxParticleStatelessEmitter()
+{
+	config = NULL;
+	threads = NULL;
+	vertices = NULL;
+	particleCount = 0;
+	startTime = 0.0f;
+	seed = 1;
+	memset( &state, 0, sizeof( state ) );
+}
+
+ofxParticleStatelessEmitter::~ofxParticleStatelessEmitter()
+{
+	exit();
+}
+
+void ofxParticleStatelessEmitter::exit()
+{
+	if ( threads != NULL )
+	{
+		threads->joinAll();
+		delete threads;
+	}
+	threads = NULL;
+	jobs.clear();
+	
+	if ( vertices != NULL )
+		free( vertices );
+	vertices = NULL;
+	
+	particleCount = 0;
+	config = NULL;
+}
+
+void ofxParticleStatelessEmitter::setup( ofxParticleEmitter* config, int numSlots, int numThreads /* = 4 */ )
+{
+	exit();
+	
+	if ( config == NULL || numSlots <= 0 )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleStatelessEmitter::setup() - config or numSlots is invalid!" );
+		return;
+	}
+	
+	this->config = config;
+	vertices = (PointSprite*)malloc( sizeof( PointSprite ) * numSlots );
+	assert( vertices );
+	
+	// The calling thread evaluates the last range itself
+	numThreads = MAX( 1, numThreads );
+	if ( numThreads > 1 )
+		threads = new Poco::ThreadPool( numThreads - 1, numThreads - 1 );
+	
+	jobs.resize( numThreads );
+	for ( int i = 0; i < numThreads; i++ )
+	{
+		jobs[i].config = &state;
+		jobs[i].first = (int)( (long long)numSlots * i / numThreads );
+		jobs[i].last = (int)( (long long)numSlots * ( i + 1 ) / numThreads );
+		jobs[i].out = &vertices[jobs[i].first];
+		jobs[i].count = 0;
+	}
+	
+	seed = (GLuint)ofRandom( 1.0f, 16777216.0f );
+	startTime = ofGetElapsedTimef();
+	state.numSlots = numSlots;
+}
+
+void ofxParticleStatelessEmitter::update()
+{
+	update( ofGetElapsedTimef() - startTime );
+}
+
+void ofxParticleStatelessEmitter::update( GLfloat time )
+{
+	if ( config == NULL ) return;
+	
+	ofxParticleStatelessConfigure( state, *config, state.numSlots, seed );
+	
+	for ( unsigned int i = 0; i < jobs.size(); i++ )
+		jobs[i].time = time;
+	
+	for ( unsigned int i = 0; i + 1 < jobs.size(); i++ )
+		threads->start( jobs[i] );
+	jobs.back().run();
+	if ( threads != NULL )
+		threads->joinAll();
+	
+	// Every range wrote its live particles packed from its own start, close the gaps between them
+	particleCount = jobs[0].count;
+	for ( unsigned int i = 1; i < jobs.size(); i++ )
+	{
+		if ( jobs[i].count > 0 )
+			memmove( &vertices[particleCount], jobs[i].out, sizeof( PointSprite ) * jobs[i].count );
+		particleCount += jobs[i].count;
+	}
+}
+
+void ofxParticleStatelessEmitter::draw( int x /* = 0 */, int y /* = 0 */ )
+{
+	if ( config == NULL ) return;
+	
+	config->drawSprites( vertices, particleCount, x, y );
+}
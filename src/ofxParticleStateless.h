@@ -0,0 +1,123 @@
+//
+// ofxParticleStateless.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_STATELESS
+#define _OFX_PARTICLE_STATELESS
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+
+#include "Poco/Runnable.h"
+#include "Poco/ThreadPool.h"
+
+// ------------------------------------------------------------------------
+// Structures
+// ------------------------------------------------------------------------
+
+// Structure that holds the emitter parameters the stateless evaluation depends on.
+// It is a plain copy so it can be read by the worker threads (or passed to a shader
+// as uniforms) while the emitter itself is being changed
+typedef struct
+{
+	int			emitterType;
+	Vector2f	sourcePosition, sourcePositionVariance;
+	GLfloat		angle, angleVariance;
+	GLfloat		speed, speedVariance;
+	Vector2f	gravity;
+	GLfloat		particleLifespan, particleLifespanVariance;
+	Color4f		startColor, startColorVariance;
+	Color4f		finishColor, finishColorVariance;
+	GLfloat		startParticleSize, startParticleSizeVariance;
+	GLfloat		finishParticleSize, finishParticleSizeVariance;
+	GLfloat		maxRadius, maxRadiusVariance, minRadius;
+	GLfloat		rotatePerSecond, rotatePerSecondVariance;
+	GLfloat		updatesPerSecond;	// Rate the stateful emitter would be updated at, see below
+	GLint		numSlots;
+	GLuint		seed;
+} ParticleStatelessConfig;
+
+// Fill a config from an emitter.  updatesPerSecond is taken from the app frame rate
+void	ofxParticleStatelessConfigure( ParticleStatelessConfig& config, const ofxParticleEmitter& emitter, int numSlots, GLuint seed );
+
+// Evaluate slots [first, last) at time seconds, writing the live ones packed from out.
+// Returns the number written.  out must have room for last - first sprites as all of it
+// may be written to.  This is a pure function of its arguments
+int		ofxParticleStatelessEvaluate( const ParticleStatelessConfig& config, GLfloat time, int first, int last, PointSprite* out );
+
+// ------------------------------------------------------------------------
+// ofxParticleStatelessEmitter
+// ------------------------------------------------------------------------
+
+// Emitter for huge particle counts that keeps no per particle state.  Each slot
+// respawns on a fixed cycle and its particle is computed directly from the slot
+// index, the time and the config using the closed forms of ofxParticleEmitter::update().
+// Like update() the color, size and radius change by a per update delta, so they are
+// evaluated for updatesPerSecond updates a second as prewarm() does, and gravity is
+// integrated the same way one update at a time.  The result matches update() at a
+// steady frame rate.  Radial and tangential acceleration have no closed form and are
+// ignored, and particles move with the source position rather than staying where
+// they were spawned.  The slots are split across a pool of threads.
+class ofxParticleStatelessEmitter
+{
+	
+public:
+	
+	ofxParticleStatelessEmitter();
+	~ofxParticleStatelessEmitter();
+	
+	// The config emitter provides the parameters, texture and blend functions and must
+	// outlive this one.  Its own maxParticles is ignored in favor of numSlots
+	void	setup( ofxParticleEmitter* config, int numSlots, int numThreads = 4 );
+	void	update();
+	void	update( GLfloat time );
+	void	draw( int x = 0, int y = 0 );
+	void	exit();
+	
+	const PointSprite*	getVertices() const { return vertices; }
+	GLint				getParticleCount() const { return particleCount; }
+	
+protected:
+	
+	class Job : public Poco::Runnable
+	{
+	public:
+		void run() { count = ofxParticleStatelessEvaluate( *config, time, first, last, out ); }
+		
+		const ParticleStatelessConfig*	config;
+		GLfloat							time;
+		int								first, last, count;
+		PointSprite*					out;
+	};
+	
+	ofxParticleEmitter*			config;
+	ParticleStatelessConfig		state;
+	Poco::ThreadPool*			threads;
+	std::vector<Job>			jobs;
+	
+	PointSprite*				vertices;
+	GLint						particleCount;
+	GLfloat						startTime;
+	GLuint						seed;
+};
+
+#endif
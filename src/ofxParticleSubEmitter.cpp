@@ -0,0 +1,160 @@
+//
+// ofxParticleSubEmitter.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticleSubEmitter.h"
+
+// ------------------------------------------------------------------------
+// Lifecycle
+// ------------------------------------------------------------------------
+
+ofxParticleSubEmitter::ofxParticleSubEmitter()
+{
+	parent = NULL;
+	currentChild = 0;
+	eventType = kParticleEventDeath;
+	particlesPerEvent = 0;
+	maxEventsPerFrame = 0;
+	numDroppedEvents = 0;
+}
+
+ofxParticleSubEmitter::~ofxParticleSubEmitter()
+{
+	exit();
+}
+
+void ofxParticleSubEmitter::exit()
+{
+	for ( unsigned int i = 0; i < pool.size(); i++ )
+		delete pool[i];
+	pool.clear();
+	
+	if ( parent != NULL )
+		parent->releaseEvents();
+	parent = NULL;
+}
+
+void ofxParticleSubEmitter::setup( ofxParticleEmitter* parent, ofxParticleEmitter* childTemplate, int eventType,
+								  int poolSize /* = 4 */, int particlesPerEvent /* = 16 */, int maxEventsPerFrame /* = 32 */ )
+{
+	exit();
+	
+	if ( parent == NULL || childTemplate == NULL || !childTemplate->isLoaded() )
+	{
+		ofLog( OF_LOG_ERROR, "ofxParticleSubEmitter::setup() - parent or template is invalid!" );
+		return;
+	}
+	
+	this->parent = parent;
+	this->eventType = eventType;
+	this->particlesPerEvent = particlesPerEvent;
+	this->maxEventsPerFrame = maxEventsPerFrame;
+	currentChild = 0;
+	numDroppedEvents = 0;
+	
+	// Other sub emitters may be listening to the same parent, so share its event arrays
+	parent->retainEvents( maxEventsPerFrame );
+	
+	for ( int i = 0; i < poolSize; i++ )
+	{
+		ofxParticleEmitter* child = new ofxParticleEmitter();
+		child->copyConfig( *childTemplate );
+		child->setEmitting( false );
+		pool.push_back( child );
+	}
+}
+
+// ------------------------------------------------------------------------
+// Update
+// ------------------------------------------------------------------------
+
+ofxParticleEmitter* ofxParticleSubEmitter::nextChild( int particlesNeeded )
+{
+	// Keep filling the current child, then move on to the next one with room
+	for ( unsigned int i = 0; i < pool.size(); i++ )
+	{
+		ofxParticleEmitter* child = pool[currentChild];
+		if ( child->maxParticles - child->getParticleCount() >= particlesNeeded )
+			return child;
+		
+		currentChild = ( currentChild + 1 ) % pool.size();
+	}
+	
+	return NULL;
+}
+
+void ofxParticleSubEmitter::update()
+{
+	if ( parent == NULL ) return;
+	
+	int count = parent->getNumEvents( eventType );
+	const ParticleEvent* events = parent->getEvents( eventType );
+	
+	// Events the parent had no room to record are lost as well.  The parent's capacity can be
+	// larger than ours when it is shared with other sub emitters
+	numDroppedEvents += parent->getNumDroppedEvents( eventType );
+	if ( count > maxEventsPerFrame )
+	{
+		numDroppedEvents += count - maxEventsPerFrame;
+		count = maxEventsPerFrame;
+	}
+	
+	for ( int i = 0; i < count; i++ )
+	{
+		ofxParticleEmitter* child = nextChild( particlesPerEvent );
+		if ( child == NULL )
+		{
+			numDroppedEvents += count - i;
+			break;
+		}
+		
+		child->burst( events[i].position, particlesPerEvent );
+	}
+	
+	// Idle children are updated too so they don't see a huge delta when they are next used
+	for ( unsigned int i = 0; i < pool.size(); i++ )
+		pool[i]->update();
+}
+
+// ------------------------------------------------------------------------
+// Render
+// ------------------------------------------------------------------------
+
+void ofxParticleSubEmitter::draw( int x /* = 0 */, int y /* = 0 */ )
+{
+	for ( unsigned int i = 0; i < pool.size(); i++ )
+	{
+		if ( pool[i]->getParticleCount() > 0 )
+			pool[i]->draw( x, y );
+	}
+}
+
+int ofxParticleSubEmitter::getNumActiveChildren() const
+{
+	int active = 0;
+	for ( unsigned int i = 0; i < pool.size(); i++ )
+	{
+		if ( pool[i]->getParticleCount() > 0 )
+			active++;
+	}
+	return active;
+}
@@ -0,0 +1,73 @@
+//
+// ofxParticleSubEmitter.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_SUB_EMITTER
+#define _OFX_PARTICLE_SUB_EMITTER
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+
+// ------------------------------------------------------------------------
+// ofxParticleSubEmitter
+// ------------------------------------------------------------------------
+
+// Spawns bursts of particles from a template emitter wherever particles of a parent
+// emitter are born or die, e.g. fireworks.  The children come from a fixed pool that
+// is allocated in setup(), every event of a frame is burst into the same child until
+// it is full, and the number of events handled per frame is capped.  Events that
+// don't fit are dropped, so nothing is allocated after setup().
+class ofxParticleSubEmitter
+{
+	
+public:
+	
+	ofxParticleSubEmitter();
+	~ofxParticleSubEmitter();
+	
+	// The parent and template must be loaded and outlive the sub emitter.  eventType is
+	// one of kParticleEvents
+	void	setup( ofxParticleEmitter* parent, ofxParticleEmitter* childTemplate, int eventType,
+				  int poolSize = 4, int particlesPerEvent = 16, int maxEventsPerFrame = 32 );
+	
+	// Call after the parent has been updated
+	void	update();
+	void	draw( int x = 0, int y = 0 );
+	void	exit();
+	
+	int		getNumActiveChildren() const;
+	int		getNumDroppedEvents() const { return numDroppedEvents; }
+	
+protected:
+	
+	ofxParticleEmitter*	nextChild( int particlesNeeded );
+	
+	ofxParticleEmitter*					parent;
+	std::vector<ofxParticleEmitter*>	pool;
+	int									currentChild;
+	int									eventType;
+	int									particlesPerEvent;
+	int									maxEventsPerFrame;
+	int									numDroppedEvents;
+};
+
+#endif
@@ -0,0 +1,326 @@
+//
+// ofxParticleSystem.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticleSystem.h"
+#include "ofxParticleTransform.h"
+
+// Largest batch a single draw call can index with 16-bit indices
+#define MAXIMUM_QUADS_PER_DRAW 16384
+
+// ------------------------------------------------------------------------
+// ofxParticleQuadBatch
+// ------------------------------------------------------------------------
+
+ofxParticleQuadBatch::ofxParticleQuadBatch()
+{
+	quads = NULL;
+	indices = NULL;
+	quadCapacity = 0;
+	indexCapacity = 0;
+	numQuads = 0;
+}
+
+ofxParticleQuadBatch::~ofxParticleQuadBatch()
+{
+	exit();
+}
+
+void ofxParticleQuadBatch::exit()
+{
+	if ( quads != NULL )
+		free( quads );
+	quads = NULL;
+	
+	if ( indices != NULL )
+		free( indices );
+	indices = NULL;
+	
+	quadCapacity = indexCapacity = numQuads = 0;
+}
+
+void ofxParticleQuadBatch::reserve( int count )
+{
+	if ( count > quadCapacity )
+	{
+		quadCapacity = MAX( count, quadCapacity * 2 );
+		quads = (ParticleQuadVertex*)realloc( quads, sizeof( ParticleQuadVertex ) * 4 * quadCapacity );
+		assert( quads );
+	}
+	
+	// The indices are the same for every draw call, so they only cover one
+	int indexCount = MIN( count, MAXIMUM_QUADS_PER_DRAW );
+	if ( indexCount > indexCapacity )
+	{
+		indices = (GLushort*)realloc( indices, sizeof( GLushort ) * 6 * indexCount );
+		assert( indices );
+		
+		for ( int i = indexCapacity; i < indexCount; i++ )
+		{
+			GLushort* index = &indices[i * 6];
+			GLushort corner = (GLushort)( i * 4 );
+			index[0] = corner;		index[1] = corner + 1;	index[2] = corner + 2;
+			index[3] = corner;		index[4] = corner + 2;	index[5] = corner + 3;
+		}
+		indexCapacity = indexCount;
+	}
+}
+
+void ofxParticleQuadBatch::append( const PointSprite* sprites, int count, const AtlasRegion& region )
+{
+	if ( count <= 0 ) return;
+	
+	reserve( numQuads + count );
+	
+	ParticleQuadVertex* q = &quads[numQuads * 4];
+	for ( int i = 0; i < count; i++, q += 4 )
+	{
+		// Sprites are centered on their position, matching the anchor used by drawTextures()
+		GLfloat half = sprites[i].size * 0.5f;
+		GLfloat x1 = sprites[i].x - half, y1 = sprites[i].y - half;
+		GLfloat x2 = sprites[i].x + half, y2 = sprites[i].y + half;
+		
+		q[0].x = x1; q[0].y = y1; q[0].u = region.u1; q[0].v = region.v1;
+		q[1].x = x2; q[1].y = y1; q[1].u = region.u2; q[1].v = region.v1;
+		q[2].x = x2; q[2].y = y2; q[2].u = region.u2; q[2].v = region.v2;
+		q[3].x = x1; q[3].y = y2; q[3].u = region.u1; q[3].v = region.v2;
+		q[0].color = q[1].color = q[2].color = q[3].color = sprites[i].color;
+	}
+	
+	numQuads += count;
+}
+
+int ofxParticleQuadBatch::draw( const ofTextureData& textureData, int blendFuncSource, int blendFuncDestination )
+{
+	if ( numQuads == 0 ) return 0;
+	
+	glEnable( GL_BLEND );
+	glBlendFunc( blendFuncSource, blendFuncDestination );
+	
+	glEnable( textureData.textureTarget );
+	glBindTexture( textureData.textureTarget, (GLuint)textureData.textureID );
+	
+	// The regions are normalized, scale them by the extent of the texture which is in
+	// pixels for rectangle textures
+	glMatrixMode( GL_TEXTURE );
+	glPushMatrix();
+	glLoadIdentity();
+	glScalef( textureData.tex_t, textureData.tex_u, 1.0f );
+	glMatrixMode( GL_MODELVIEW );
+	
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+	glEnableClientState( GL_COLOR_ARRAY );
+	
+	int numDrawCalls = 0;
+	for ( int first = 0; first < numQuads; first += MAXIMUM_QUADS_PER_DRAW )
+	{
+		int count = MIN( numQuads - first, MAXIMUM_QUADS_PER_DRAW );
+		ParticleQuadVertex* q = &quads[first * 4];
+		
+		glVertexPointer( 2, GL_FLOAT, sizeof( ParticleQuadVertex ), &q->x );
+		glTexCoordPointer( 2, GL_FLOAT, sizeof( ParticleQuadVertex ), &q->u );
+		glColorPointer( 4, GL_FLOAT, sizeof( ParticleQuadVertex ), &q->color );
+		
+		glDrawElements( GL_TRIANGLES, count * 6, GL_UNSIGNED_SHORT, indices );
+		numDrawCalls++;
+	}
+	
+	glDisableClientState( GL_COLOR_ARRAY );
+	glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+	glDisableClientState( GL_VERTEX_ARRAY );
+	
+	glMatrixMode( GL_TEXTURE );
+	glPopMatrix();
+	glMatrixMode( GL_MODELVIEW );
+	
+	glBindTexture( textureData.textureTarget, 0 );
+	glDisable( textureData.textureTarget );
+	glDisable( GL_BLEND );
+	
+	return numDrawCalls;
+}
+
+// ------------------------------------------------------------------------
+// Lifecycle
+// ------------------------------------------------------------------------
+
+ofxParticleSystem::ofxParticleSystem()
+{
+	atlas = NULL;
+	numDrawCalls = 0;
+}
+
+ofxParticleSystem::~ofxParticleSystem()
+{
+	exit();
+}
+
+void ofxParticleSystem::exit()
+{
+	batch.exit();
+	
+	emitters.clear();
+	sorted.clear();
+	handles.clear();
+}
+
+int ofxParticleSystem::addEmitter( ofxParticleEmitter* emitter )
+{
+	if ( emitter == NULL ) return -1;
+	
+	emitters.push_back( emitter );
+	handles.push_back( emitter );
+	return handles.size() - 1;
+}
+
+void ofxParticleSystem::removeEmitter( ofxParticleEmitter* emitter )
+{
+	std::vector<ofxParticleEmitter*>::iterator it = std::find( emitters.begin(), emitters.end(), emitter );
+	if ( it != emitters.end() )
+		emitters.erase( it );
+	
+	it = std::find( handles.begin(), handles.end(), emitter );
+	if ( it != handles.end() )
+		*it = NULL;
+}
+
+void ofxParticleSystem::setAtlas( ofxParticleAtlas* atlas )
+{
+	this->atlas = atlas;
+}
+
+// ------------------------------------------------------------------------
+// Update
+// ------------------------------------------------------------------------
+
+void ofxParticleSystem::updateEmitters( const ParticleEmitterUpdate* updates, int count )
+{
+	int numHandles = handles.size();
+	for ( int i = 0; i < count; i++ )
+	{
+		const ParticleEmitterUpdate& update = updates[i];
+		if ( update.handle < 0 || update.handle >= numHandles || handles[update.handle] == NULL )
+			continue;
+		
+		ofxParticleEmitter* emitter = handles[update.handle];
+		emitter->sourcePosition = update.position;
+		emitter->setEmitting( update.active != 0 );
+	}
+}
+
+void ofxParticleSystem::update()
+{
+	// Propagate the transforms first, parents shared by several emitters are only
+	// recomputed once
+	for ( unsigned int i = 0; i < emitters.size(); i++ )
+	{
+		if ( emitters[i]->getTransform() != NULL )
+			emitters[i]->getTransform()->updateWorld();
+	}
+	
+	for ( unsigned int i = 0; i < emitters.size(); i++ )
+		emitters[i]->update();
+}
+
+// ------------------------------------------------------------------------
+// Render
+// ------------------------------------------------------------------------
+
+// Order used to group emitters into batches.  Layers always come first so they
+// composite correctly, within a layer anything not in an atlas sorts last
+struct ofxParticleSystemBatchOrder
+{
+	bool operator()( ofxParticleEmitter* a, ofxParticleEmitter* b ) const
+	{
+		if ( a->layer != b->layer ) return a->layer < b->layer;
+		
+		int pageA = a->getAtlasRegion().page;
+		int pageB = b->getAtlasRegion().page;
+		if ( pageA != pageB ) return (unsigned int)pageA < (unsigned int)pageB;
+		if ( a->blendFuncSource != b->blendFuncSource ) return a->blendFuncSource < b->blendFuncSource;
+		return a->blendFuncDestination < b->blendFuncDestination;
+	}
+};
+
+static bool sameBatch( ofxParticleEmitter* a, ofxParticleEmitter* b )
+{
+	return a->layer == b->layer &&
+		a->getAtlasRegion().page == b->getAtlasRegion().page &&
+		a->blendFuncSource == b->blendFuncSource &&
+		a->blendFuncDestination == b->blendFuncDestination;
+}
+
+void ofxParticleSystem::sortEmitters()
+{
+	sorted = emitters;
+	
+	// Stable so emitters within a batch keep the order they were added in
+	std::stable_sort( sorted.begin(), sorted.end(), ofxParticleSystemBatchOrder() );
+}
+
+void ofxParticleSystem::draw( int x /* = 0 */, int y /* = 0 */ )
+{
+	numDrawCalls = 0;
+	if ( emitters.empty() ) return;
+	
+	sortEmitters();
+	
+	glPushMatrix();
+	glTranslatef( x, y, 0.0f );
+	
+	unsigned int first = 0;
+	while ( first < sorted.size() )
+	{
+		if ( atlas == NULL || sorted[first]->getAtlasRegion().page < 0 || 
+			sorted[first]->getAtlasRegion().page >= atlas->getNumPages() )
+		{
+			sorted[first]->draw();
+			numDrawCalls++;
+			first++;
+			continue;
+		}
+		
+		unsigned int last = first + 1;
+		while ( last < sorted.size() && sameBatch( sorted[first], sorted[last] ) )
+			last++;
+		
+		drawBatch( first, last );
+		first = last;
+	}
+	
+	glPopMatrix();
+}
+
+void ofxParticleSystem::drawBatch( int first, int last )
+{
+	// Emitters that stopped keep their last vertices, draw() hides them so skip them here too
+	batch.clear();
+	for ( int i = first; i < last; i++ )
+	{
+		if ( sorted[i]->isActive() )
+			batch.append( sorted[i]->getVertices(), sorted[i]->getParticleCount(), sorted[i]->getAtlasRegion() );
+	}
+	
+	ofTextureData textureData = atlas->getPage( sorted[first]->getAtlasRegion().page )->getTextureData();
+	numDrawCalls += batch.draw( textureData, sorted[first]->blendFuncSource, sorted[first]->blendFuncDestination );
+}
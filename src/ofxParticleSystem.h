@@ -0,0 +1,136 @@
+//
+// ofxParticleSystem.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_SYSTEM
+#define _OFX_PARTICLE_SYSTEM
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+#include "ofxParticleAtlas.h"
+
+// ------------------------------------------------------------------------
+// Structures
+// ------------------------------------------------------------------------
+
+// Structure that holds one corner of a particle quad for batched drawing
+typedef struct
+{
+	GLfloat		x;
+	GLfloat		y;
+	GLfloat		u;
+	GLfloat		v;
+	Color4f		color;
+} ParticleQuadVertex;
+
+// Structure that holds one entry of a batched emitter update, see
+// ofxParticleSystem::updateEmitters() and ofxParticleGroup::updateSources()
+typedef struct
+{
+	GLint		handle;
+	Vector2f	position;
+	GLint		active;		// Non zero to keep emitting
+} ParticleEmitterUpdate;
+
+// ------------------------------------------------------------------------
+// ofxParticleQuadBatch
+// ------------------------------------------------------------------------
+
+// Collects sprites as textured quads and draws them with indexed triangles, so it
+// works with OpenGL ES too.  16-bit indices limit a draw call to 16384 quads, bigger
+// batches are split.
+class ofxParticleQuadBatch
+{
+	
+public:
+	
+	ofxParticleQuadBatch();
+	~ofxParticleQuadBatch();
+	
+	void	clear() { numQuads = 0; }
+	void	exit();
+	
+	// region is normalized, see AtlasRegion
+	void	append( const PointSprite* sprites, int count, const AtlasRegion& region );
+	
+	// Returns the number of draw calls it took
+	int		draw( const ofTextureData& textureData, int blendFuncSource, int blendFuncDestination );
+	
+	int		getNumQuads() const { return numQuads; }
+	
+protected:
+	
+	void	reserve( int count );
+	
+	ParticleQuadVertex*	quads;
+	GLushort*			indices;		// 6 per quad, enough for one draw call
+	int					quadCapacity;	// In quads, each takes 4 vertices
+	int					indexCapacity;	// In quads
+	int					numQuads;
+};
+
+// ------------------------------------------------------------------------
+// ofxParticleSystem
+// ------------------------------------------------------------------------
+
+// Updates and draws a set of emitters.  Emitters are drawn in order of their layer,
+// within a layer the ones placed in an atlas are sorted by atlas page and blend
+// function, and each run of emitters sharing
+// both is drawn with a single ofxParticleQuadBatch.  Emitters without an atlas region
+// fall back to their own draw().
+class ofxParticleSystem
+{
+	
+public:
+	
+	ofxParticleSystem();
+	~ofxParticleSystem();
+	
+	// Returns a handle for updateEmitters(), or -1.  Handles of removed emitters aren't reused
+	int		addEmitter( ofxParticleEmitter* emitter );
+	void	removeEmitter( ofxParticleEmitter* emitter );
+	
+	// Move and start or stop many emitters in one call.  Unknown handles are skipped
+	void	updateEmitters( const ParticleEmitterUpdate* updates, int count );
+	void	setAtlas( ofxParticleAtlas* atlas );
+	
+	void	update();
+	void	draw( int x = 0, int y = 0 );
+	void	exit();
+	
+	int		getNumDrawCalls() const { return numDrawCalls; }
+	
+protected:
+	
+	void	sortEmitters();
+	void	drawBatch( int first, int last );
+	
+	std::vector<ofxParticleEmitter*>	emitters;
+	std::vector<ofxParticleEmitter*>	sorted;
+	std::vector<ofxParticleEmitter*>	handles;	// Indexed by handle, NULL once removed
+	ofxParticleAtlas*					atlas;
+	
+	ofxParticleQuadBatch				batch;
+	int									numDrawCalls;
+};
+
+#endif
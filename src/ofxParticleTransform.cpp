@@ -0,0 +1,89 @@
+//
+// ofxParticleTransform.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofxParticleTransform.h"
+
+// ------------------------------------------------------------------------
+// Lifecycle
+// ------------------------------------------------------------------------
+
+ofxParticleTransform::ofxParticleTransform()
+{
+	parent = NULL;
+	
+	position = Vector2fZero;
+	rotation = 0.0f;
+	scale = Vector2fMake( 1.0f, 1.0f );
+	
+	world = Affine2fIdentity;
+	dirty = false;
+	version = 0;
+	parentVersion = 0;
+}
+
+// ------------------------------------------------------------------------
+// Hierarchy
+// ------------------------------------------------------------------------
+
+bool ofxParticleTransform::setParent( ofxParticleTransform* parent )
+{
+	for ( ofxParticleTransform* node = parent; node != NULL; node = node->parent )
+	{
+		if ( node == this )
+		{
+			ofLog( OF_LOG_ERROR, "ofxParticleTransform::setParent() - parent is a child of this node!" );
+			return false;
+		}
+	}
+	
+	this->parent = parent;
+	dirty = true;
+	return true;
+}
+
+void ofxParticleTransform::updateWorld()
+{
+	if ( parent != NULL )
+	{
+		parent->updateWorld();
+		if ( parent->version != parentVersion )
+			dirty = true;
+	}
+	
+	if ( !dirty )
+		return;
+	
+	Affine2f local = Affine2fMake( position, rotation, scale );
+	if ( parent != NULL )
+	{
+		world = Affine2fConcat( parent->world, local );
+		parentVersion = parent->version;
+	}
+	else
+	{
+		world = local;
+	}
+	
+	version++;
+	dirty = false;
+}
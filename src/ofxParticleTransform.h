@@ -0,0 +1,137 @@
+//
+// ofxParticleTransform.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _OFX_PARTICLE_TRANSFORM
+#define _OFX_PARTICLE_TRANSFORM
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+
+// ------------------------------------------------------------------------
+// Structures
+// ------------------------------------------------------------------------
+
+// Structure that holds a 2D affine transform, x' = a * x + c * y + tx and
+// y' = b * x + d * y + ty
+typedef struct
+{
+	GLfloat a, b;
+	GLfloat c, d;
+	GLfloat tx, ty;
+} Affine2f;
+
+// ------------------------------------------------------------------------
+// Inline functions
+// ------------------------------------------------------------------------
+
+// Return the identity transform
+static const Affine2f Affine2fIdentity = {1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f};
+
+// Return a transform that scales, then rotates by degrees, then translates
+static inline Affine2f Affine2fMake(Vector2f position, GLfloat degrees, Vector2f scale) {
+	GLfloat radians = (GLfloat)DEGREES_TO_RADIANS(degrees);
+	GLfloat cs = cosf(radians), sn = sinf(radians);
+	Affine2f m;
+	m.a = cs * scale.x;		m.b = sn * scale.x;
+	m.c = -sn * scale.y;	m.d = cs * scale.y;
+	m.tx = position.x;		m.ty = position.y;
+	return m;
+}
+
+// Return the transform that applies m2 and then m1
+static inline Affine2f Affine2fConcat(Affine2f m1, Affine2f m2) {
+	Affine2f m;
+	m.a = m1.a * m2.a + m1.c * m2.b;
+	m.b = m1.b * m2.a + m1.d * m2.b;
+	m.c = m1.a * m2.c + m1.c * m2.d;
+	m.d = m1.b * m2.c + m1.d * m2.d;
+	m.tx = m1.a * m2.tx + m1.c * m2.ty + m1.tx;
+	m.ty = m1.b * m2.tx + m1.d * m2.ty + m1.ty;
+	return m;
+}
+
+// Return the point v transformed by m
+static inline Vector2f Affine2fApply(Affine2f m, Vector2f v) {
+	return Vector2fMake(m.a * v.x + m.c * v.y + m.tx, m.b * v.x + m.d * v.y + m.ty);
+}
+
+// Return the direction v transformed by m, ignoring the translation
+static inline Vector2f Affine2fApplyLinear(Affine2f m, Vector2f v) {
+	return Vector2fMake(m.a * v.x + m.c * v.y, m.b * v.x + m.d * v.y);
+}
+
+// Return how much m scales lengths on average, used for particle sizes
+static inline GLfloat Affine2fScale(Affine2f m) {
+	return sqrtf(fabsf(m.a * m.d - m.b * m.c));
+}
+
+// ------------------------------------------------------------------------
+// ofxParticleTransform
+// ------------------------------------------------------------------------
+
+// A node with a position, rotation and scale relative to an optional parent.  The world
+// transform is cached and only recomputed by updateWorld() after the node or one of its
+// parents changed.  Parents must outlive their children.
+class ofxParticleTransform
+{
+	
+public:
+	
+	ofxParticleTransform();
+	
+	// Returns false, leaving the parent alone, if it would create a cycle
+	bool					setParent( ofxParticleTransform* parent );
+	ofxParticleTransform*	getParent() const { return parent; }
+	
+	void			setPosition( const Vector2f& position ) { this->position = position; dirty = true; }
+	void			setRotation( GLfloat degrees ) { rotation = degrees; dirty = true; }
+	void			setScale( const Vector2f& scale ) { this->scale = scale; dirty = true; }
+	void			setScale( GLfloat scale ) { setScale( Vector2fMake( scale, scale ) ); }
+	
+	const Vector2f&	getPosition() const { return position; }
+	GLfloat			getRotation() const { return rotation; }
+	const Vector2f&	getScale() const { return scale; }
+	
+	// Bring the world transform up to date, parents first.  Nodes that are already up to
+	// date only compare a counter with their parent, so calling it for every emitter
+	// sharing a parent recomputes the parent once
+	void			updateWorld();
+	
+	// As of the last updateWorld()
+	const Affine2f&	getWorldTransform() const { return world; }
+	
+protected:
+	
+	ofxParticleTransform*	parent;
+	
+	Vector2f		position;
+	GLfloat			rotation;		// In degrees
+	Vector2f		scale;
+	
+	Affine2f		world;
+	bool			dirty;
+	unsigned int	version;		// Incremented whenever world changes
+	unsigned int	parentVersion;	// The parents version world was computed from
+};
+
+#endif
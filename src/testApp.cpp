@@ -12,6 +12,9 @@ void testApp::setup()
 	{
 		ofLog( OF_LOG_ERROR, "testApp::setup() - failed to load emitter config" );
 	}
+	
+	// pick up edits to the config without restarting
+	m_watcher.watch( &m_emitter, "circles.pex" );
 }
 
 //--------------------------------------------------------------
@@ -23,6 +26,7 @@ void testApp::exit()
 //--------------------------------------------------------------
 void testApp::update()
 {
+	m_watcher.update();
 	m_emitter.update();
 }
 
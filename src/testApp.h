@@ -4,6 +4,7 @@
 
 #include "ofMain.h"
 #include "ofxParticleEmitter.h"
+#include "ofxParticleEmitterWatcher.h"
 
 class testApp : public ofBaseApp
 {
@@ -26,6 +27,7 @@ public:
 protected:
 	
 	ofxParticleEmitter		m_emitter;
+	ofxParticleEmitterWatcher	m_watcher;
 	
 };
 
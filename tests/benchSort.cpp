@@ -0,0 +1,98 @@
+//
+// benchSort.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Times update() of a full 100k particle emitter in each sort mode.  The last case
+// scrambles the pool before every frame so the age sort has to sort all of it rather
+// than merge in the new particles, which is what happens when the mode is switched on
+
+#include "ofxParticleEmitter.h"
+#include "testUtil.h"
+
+#define BENCH_PARTICLES		100000
+#define BENCH_FRAMES		120
+#define BENCH_FRAME_MILLIS	16
+
+// Opens up the pool so it can be scrambled
+class BenchEmitter : public ofxParticleEmitter
+{
+public:
+	void scramble( GLuint& state )
+	{
+		for ( GLint i = particleCount - 1; i > 0; i-- )
+		{
+			GLint j = (GLint)( Xorshift32Random0To1( state ) * ( i + 1 ) ) % ( i + 1 );
+			Particle tmp = particles[i];
+			particles[i] = particles[j];
+			particles[j] = tmp;
+		}
+	}
+};
+
+static void bench( const char* name, int sortMode, bool scramble )
+{
+	ofSeedRandom( 1 );
+	ofStubSetElapsedTimeMillis( 0 );
+	
+	BenchEmitter emitter;
+	emitter.loadConfigFromString( testConfig( BENCH_PARTICLES, 2.0f, 1.5f ) );
+	emitter.finishLoading();
+	emitter.setRandomSeed( 1 );
+	emitter.sortMode = sortMode;
+	emitter.prewarm( 4.0f );
+	
+	GLuint state = 7;
+	double total = 0, worst = 0;
+	int millis = 0;
+	for ( int frame = 0; frame < BENCH_FRAMES; frame++ )
+	{
+		if ( scramble )
+			emitter.scramble( state );
+		
+		millis += BENCH_FRAME_MILLIS;
+		ofStubSetElapsedTimeMillis( millis );
+		
+		double start = testSeconds();
+		emitter.update();
+		double elapsed = testSeconds() - start;
+		
+		total += elapsed;
+		worst = MAX( worst, elapsed );
+	}
+	
+	printf( "  %-22s %7d particles  %7.3f ms/frame  %7.3f ms worst\n", name,
+		emitter.getParticleCount(), total * 1000.0 / BENCH_FRAMES, worst * 1000.0 );
+	
+	emitter.exit();
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_ERROR );
+	
+	bench( "none", kParticleSortNone, false );
+	bench( "spawn order", kParticleSortSpawnOrder, false );
+	bench( "age", kParticleSortAge, false );
+	bench( "age (scrambled)", kParticleSortAge, true );
+	
+	return 0;
+}
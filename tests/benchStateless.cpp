@@ -0,0 +1,110 @@
+//
+// benchStateless.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Compares 100k particles simulated by a stateful ofxParticleEmitter with the same config
+// evaluated by ofxParticleStatelessEvaluate() on one thread and by an
+// ofxParticleStatelessEmitter across four, for both emitter types
+
+#include "ofxParticleEmitter.h"
+#include "ofxParticleStateless.h"
+#include "testUtil.h"
+
+#define BENCH_PARTICLES		100000
+#define BENCH_FRAMES		120
+#define BENCH_FRAME_MILLIS	16
+
+static const char* radialConfig = "<emitterType value=\"1\"/><maxRadius value=\"120\"/><maxRadiusVariance value=\"20\"/>"
+	"<minRadius value=\"5\"/><rotatePerSecond value=\"90\"/><rotatePerSecondVariance value=\"30\"/>";
+
+static void report( const char* name, int particles, double total )
+{
+	printf( "  %-28s %7d particles  %7.3f ms/frame\n", name, particles, total * 1000.0 / BENCH_FRAMES );
+}
+
+static void bench( const char* type, const std::string& extra )
+{
+	ofSeedRandom( 1 );
+	ofStubSetElapsedTimeMillis( 0 );
+	
+	ofxParticleEmitter emitter;
+	emitter.loadConfigFromString( testConfig( BENCH_PARTICLES, 2.0f, 0.5f, extra ) );
+	emitter.finishLoading();
+	emitter.prewarm( 4.0f );
+	
+	printf( "%s\n", type );
+	
+	// Stateful
+	double total = 0;
+	int millis = 0;
+	for ( int frame = 0; frame < BENCH_FRAMES; frame++ )
+	{
+		millis += BENCH_FRAME_MILLIS;
+		ofStubSetElapsedTimeMillis( millis );
+		
+		double start = testSeconds();
+		emitter.update();
+		total += testSeconds() - start;
+	}
+	report( "stateful update()", emitter.getParticleCount(), total );
+	
+	// Stateless, one thread
+	ParticleStatelessConfig config;
+	ofxParticleStatelessConfigure( config, emitter, BENCH_PARTICLES, 1 );
+	std::vector<PointSprite> sprites( BENCH_PARTICLES );
+	
+	int count = 0;
+	total = 0;
+	for ( int frame = 0; frame < BENCH_FRAMES; frame++ )
+	{
+		double start = testSeconds();
+		count = ofxParticleStatelessEvaluate( config, 4.0f + frame * BENCH_FRAME_MILLIS / 1000.0f, 0, BENCH_PARTICLES, &sprites[0] );
+		total += testSeconds() - start;
+	}
+	report( "stateless, 1 thread", count, total );
+	
+	// Stateless, four threads
+	ofxParticleStatelessEmitter stateless;
+	stateless.setup( &emitter, BENCH_PARTICLES, 4 );
+	
+	total = 0;
+	for ( int frame = 0; frame < BENCH_FRAMES; frame++ )
+	{
+		double start = testSeconds();
+		stateless.update( 4.0f + frame * BENCH_FRAME_MILLIS / 1000.0f );
+		total += testSeconds() - start;
+	}
+	report( "stateless, 4 threads", stateless.getParticleCount(), total );
+	
+	stateless.exit();
+	emitter.exit();
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_ERROR );
+	
+	bench( "gravity", "" );
+	bench( "radial", radialConfig );
+	
+	return 0;
+}
@@ -0,0 +1,101 @@
+//
+// fuzzConfig.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Fuzzer for .pex parsing and the simulation of whatever comes out of it.  Built by
+// `make fuzz` as a libFuzzer target, which needs clang.  Built with any other compiler
+// it has its own main() that runs the files given on the command line, or without
+// arguments a fixed number of generated hostile configs, so `make test` covers it too.
+
+#include "ofxParticleEmitter.h"
+#include "testUtil.h"
+
+#include <stdint.h>
+
+#define FUZZ_FRAMES				8
+#define FUZZ_GENERATED_INPUTS	2000
+
+// Frame lengths in milliseconds, including a stall and a clock that went backwards
+static const int frameMillis[FUZZ_FRAMES] = { 16, 0, 16, 1000, 16, 100000, -50, 16 };
+
+extern "C" int LLVMFuzzerTestOneInput( const uint8_t* data, size_t size )
+{
+	ofSetLogLevel( OF_LOG_SILENT );
+	ofStubSetElapsedTimeMillis( 100000 );
+	
+	ofxParticleEmitter emitter;
+	if ( !emitter.loadConfigFromString( std::string( (const char*)data, size ) ) )
+		return 0;
+	emitter.finishLoading();
+	
+	int millis = 100000;
+	for ( int i = 0; i < FUZZ_FRAMES; i++ )
+	{
+		millis += frameMillis[i];
+		ofStubSetElapsedTimeMillis( millis );
+		emitter.update();
+		
+		if ( !testEmitterIsSane( emitter ) )
+		{
+			fprintf( stderr, "fuzzConfig: bad particles after frame %d\n", i );
+			abort();
+		}
+	}
+	
+	emitter.exit();
+	return 0;
+}
+
+#ifndef TEST_LIBFUZZER
+
+int main( int argc, char** argv )
+{
+	if ( argc > 1 )
+	{
+		for ( int i = 1; i < argc; i++ )
+		{
+			std::ifstream file( argv[i], std::ios::binary );
+			std::ostringstream input;
+			input << file.rdbuf();
+			std::string config = input.str();
+			LLVMFuzzerTestOneInput( (const uint8_t*)config.data(), config.size() );
+		}
+		return 0;
+	}
+	
+	GLuint state = 12345;
+	for ( int i = 0; i < FUZZ_GENERATED_INPUTS; i++ )
+	{
+		std::string config = testConfig( 1 + i % 2000, 1.0f, 0.5f, testHostileConfig( state ) );
+		
+		// Every so often cut the file short as well
+		if ( i % 10 == 0 )
+			config.resize( (size_t)( Xorshift32Random0To1( state ) * config.size() ) );
+		
+		LLVMFuzzerTestOneInput( (const uint8_t*)config.data(), config.size() );
+	}
+	
+	printf( "  %d generated configs\n", FUZZ_GENERATED_INPUTS );
+	return 0;
+}
+
+#endif
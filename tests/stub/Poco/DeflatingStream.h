@@ -0,0 +1,54 @@
+//
+// DeflatingStream.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _POCO_DEFLATING_STREAM_STUB
+#define _POCO_DEFLATING_STREAM_STUB
+
+#include <ostream>
+#include <sstream>
+
+namespace Poco
+{
+	class DeflatingStreamBuf
+	{
+	public:
+		enum StreamType { STREAM_ZLIB, STREAM_GZIP };
+	};
+	
+	// Collects the data and writes it to out deflated with zlib on close(), only the
+	// zlib stream type is supported
+	class DeflatingOutputStream : public std::ostream
+	{
+	public:
+		DeflatingOutputStream( std::ostream& out, DeflatingStreamBuf::StreamType type = DeflatingStreamBuf::STREAM_ZLIB, int level = -1 );
+		~DeflatingOutputStream();
+		int		close();
+	protected:
+		std::stringbuf	buffer;
+		std::ostream&	out;
+		int				level;
+		bool			closed;
+	};
+}
+
+#endif
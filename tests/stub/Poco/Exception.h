@@ -0,0 +1,50 @@
+//
+// Exception.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _POCO_EXCEPTION_STUB
+#define _POCO_EXCEPTION_STUB
+
+#include <exception>
+#include <string>
+
+namespace Poco
+{
+	class Exception : public std::exception
+	{
+	public:
+		Exception( const std::string& message ) : message( message ) {}
+		~Exception() throw() {}
+		const char*			what() const throw() { return message.c_str(); }
+		const std::string&	displayText() const { return message; }
+	protected:
+		std::string	message;
+	};
+	
+	class IOException : public Exception
+	{
+	public:
+		IOException( const std::string& message ) : Exception( message ) {}
+	};
+}
+
+#endif
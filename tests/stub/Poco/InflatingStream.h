@@ -0,0 +1,49 @@
+//
+// InflatingStream.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _POCO_INFLATING_STREAM_STUB
+#define _POCO_INFLATING_STREAM_STUB
+
+#include <istream>
+#include <sstream>
+
+namespace Poco
+{
+	class InflatingStreamBuf
+	{
+	public:
+		enum StreamType { STREAM_ZLIB, STREAM_GZIP };
+	};
+	
+	// Inflates everything left in the zlib stream in up front and reads from the result.
+	// Damaged or cut off data throws a Poco::IOException like Poco does
+	class InflatingInputStream : public std::istream
+	{
+	public:
+		InflatingInputStream( std::istream& in, InflatingStreamBuf::StreamType type = InflatingStreamBuf::STREAM_ZLIB );
+	protected:
+		std::stringbuf	buffer;
+	};
+}
+
+#endif
@@ -0,0 +1,55 @@
+//
+// Mutex.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _POCO_MUTEX_STUB
+#define _POCO_MUTEX_STUB
+
+#include <pthread.h>
+
+namespace Poco
+{
+	class FastMutex
+	{
+	public:
+		FastMutex() { pthread_mutex_init( &mutex, NULL ); }
+		~FastMutex() { pthread_mutex_destroy( &mutex ); }
+		void	lock() { pthread_mutex_lock( &mutex ); }
+		void	unlock() { pthread_mutex_unlock( &mutex ); }
+		bool	tryLock() { return pthread_mutex_trylock( &mutex ) == 0; }
+		
+		class ScopedLock
+		{
+		public:
+			ScopedLock( FastMutex& mutex ) : mutex( mutex ) { mutex.lock(); }
+			~ScopedLock() { mutex.unlock(); }
+		protected:
+			FastMutex&	mutex;
+		};
+	protected:
+		pthread_mutex_t	mutex;
+	};
+	
+	typedef FastMutex Mutex;
+}
+
+#endif
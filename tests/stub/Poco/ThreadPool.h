@@ -0,0 +1,49 @@
+//
+// ThreadPool.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef _POCO_THREAD_POOL_STUB
+#define _POCO_THREAD_POOL_STUB
+
+#include "Poco/Runnable.h"
+
+#include <pthread.h>
+#include <vector>
+
+namespace Poco
+{
+	// Starts a new thread per job, which is all the particle classes need
+	class ThreadPool
+	{
+	public:
+		ThreadPool( int minCapacity = 2, int maxCapacity = 16, int idleTime = 60, int stackSize = 0 );
+		~ThreadPool();
+		void		start( Runnable& target );
+		void		joinAll();
+		int			capacity() const { return maxCapacity; }
+	protected:
+		std::vector<pthread_t>	threads;
+		int						maxCapacity;
+	};
+}
+
+#endif
@@ -0,0 +1,230 @@
+//
+// PocoStub.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Poco/Thread.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/Event.h"
+#include "Poco/DeflatingStream.h"
+#include "Poco/InflatingStream.h"
+#include "Poco/Exception.h"
+
+#include <cstring>
+#include <sched.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+static void* runTarget( void* target )
+{
+	( (Poco::Runnable*)target )->run();
+	return NULL;
+}
+
+// ------------------------------------------------------------------------
+// Thread
+// ------------------------------------------------------------------------
+
+Poco::Thread::Thread()
+{
+	running = false;
+}
+
+void Poco::Thread::start( Runnable& target )
+{
+	running = pthread_create( &thread, NULL, runTarget, &target ) == 0;
+}
+
+void Poco::Thread::join()
+{
+	if ( running )
+		pthread_join( thread, NULL );
+	running = false;
+}
+
+void Poco::Thread::sleep( long milliseconds )
+{
+	usleep( milliseconds * 1000 );
+}
+
+void Poco::Thread::yield()
+{
+	sched_yield();
+}
+
+// ------------------------------------------------------------------------
+// ThreadPool
+// ------------------------------------------------------------------------
+
+Poco::ThreadPool::ThreadPool( int minCapacity, int maxCapacity, int idleTime, int stackSize )
+{
+	this->maxCapacity = maxCapacity;
+}
+
+Poco::ThreadPool::~ThreadPool()
+{
+	joinAll();
+}
+
+void Poco::ThreadPool::start( Runnable& target )
+{
+	pthread_t thread;
+	if ( pthread_create( &thread, NULL, runTarget, &target ) == 0 )
+		threads.push_back( thread );
+}
+
+void Poco::ThreadPool::joinAll()
+{
+	for ( size_t i = 0; i < threads.size(); i++ )
+		pthread_join( threads[i], NULL );
+	threads.clear();
+}
+
+// ------------------------------------------------------------------------
+// Event
+// ------------------------------------------------------------------------
+
+Poco::Event::Event( bool autoReset )
+{
+	pthread_mutex_init( &mutex, NULL );
+	pthread_cond_init( &condition, NULL );
+	state = false;
+	this->autoReset = autoReset;
+}
+
+Poco::Event::~Event()
+{
+	pthread_cond_destroy( &condition );
+	pthread_mutex_destroy( &mutex );
+}
+
+void Poco::Event::set()
+{
+	pthread_mutex_lock( &mutex );
+	state = true;
+	pthread_cond_broadcast( &condition );
+	pthread_mutex_unlock( &mutex );
+}
+
+void Poco::Event::reset()
+{
+	pthread_mutex_lock( &mutex );
+	state = false;
+	pthread_mutex_unlock( &mutex );
+}
+
+void Poco::Event::wait()
+{
+	pthread_mutex_lock( &mutex );
+	while ( !state )
+		pthread_cond_wait( &condition, &mutex );
+	if ( autoReset )
+		state = false;
+	pthread_mutex_unlock( &mutex );
+}
+
+bool Poco::Event::tryWait( long milliseconds )
+{
+	timeval now;
+	gettimeofday( &now, NULL );
+	timespec until;
+	long micros = now.tv_usec + milliseconds * 1000;
+	until.tv_sec = now.tv_sec + micros / 1000000;
+	until.tv_nsec = ( micros % 1000000 ) * 1000;
+	
+	pthread_mutex_lock( &mutex );
+	int result = 0;
+	while ( !state && result == 0 )
+		result = pthread_cond_timedwait( &condition, &mutex, &until );
+	bool signalled = state;
+	if ( signalled && autoReset )
+		state = false;
+	pthread_mutex_unlock( &mutex );
+	return signalled;
+}
+
+// ------------------------------------------------------------------------
+// DeflatingOutputStream and InflatingInputStream
+// ------------------------------------------------------------------------
+
+Poco::DeflatingOutputStream::DeflatingOutputStream( std::ostream& out, DeflatingStreamBuf::StreamType type, int level )
+	: std::ostream( NULL ), out( out )
+{
+	rdbuf( &buffer );
+	this->level = level;
+	closed = false;
+}
+
+Poco::DeflatingOutputStream::~DeflatingOutputStream()
+{
+	close();
+}
+
+int Poco::DeflatingOutputStream::close()
+{
+	if ( closed ) return 0;
+	closed = true;
+	
+	std::string data = buffer.str();
+	uLongf size = compressBound( data.size() );
+	std::string compressed( size, '\0' );
+	if ( compress2( (Bytef*)&compressed[0], &size, (const Bytef*)data.data(), data.size(), level ) != Z_OK )
+	{
+		setstate( std::ios::badbit );
+		return -1;
+	}
+	out.write( compressed.data(), size );
+	return 0;
+}
+
+Poco::InflatingInputStream::InflatingInputStream( std::istream& in, InflatingStreamBuf::StreamType type )
+	: std::istream( NULL )
+{
+	std::ostringstream source;
+	source << in.rdbuf();
+	std::string compressed = source.str();
+	
+	z_stream stream;
+	memset( &stream, 0, sizeof( stream ) );
+	inflateInit( &stream );
+	stream.next_in = (Bytef*)compressed.data();
+	stream.avail_in = compressed.size();
+	
+	std::string inflated;
+	char chunk[16384];
+	int result = Z_OK;
+	while ( result == Z_OK )
+	{
+		stream.next_out = (Bytef*)chunk;
+		stream.avail_out = sizeof( chunk );
+		result = inflate( &stream, Z_NO_FLUSH );
+		inflated.append( chunk, sizeof( chunk ) - stream.avail_out );
+	}
+	inflateEnd( &stream );
+	
+	// The whole stream is always there, so anything but a clean end means damaged data
+	if ( result != Z_STREAM_END )
+		throw Poco::IOException( zError( result ) );
+	
+	buffer.str( inflated );
+	rdbuf( &buffer );
+}
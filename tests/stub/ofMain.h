@@ -0,0 +1,216 @@
+//
+// ofMain.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Just enough of openFrameworks to build and run the particle classes without a window
+// or GL context.  GL calls do nothing, images are a fixed 8x8 sprite and the clock can
+// be frozen with ofStubSetElapsedTimeMillis().
+
+#ifndef _OF_MAIN_STUB
+#define _OF_MAIN_STUB
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <cstdio>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+
+#define TARGET_LINUX
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+#ifndef TWO_PI
+#define TWO_PI 6.28318530717958647693
+#endif
+#ifndef MAX
+#define MAX(x,y) (((x) > (y)) ? (x) : (y))
+#endif
+#ifndef MIN
+#define MIN(x,y) (((x) < (y)) ? (x) : (y))
+#endif
+
+// ------------------------------------------------------------------------
+// GL
+// ------------------------------------------------------------------------
+
+typedef float			GLfloat;
+typedef int				GLint;
+typedef unsigned int	GLuint;
+typedef unsigned int	GLenum;
+typedef unsigned short	GLushort;
+typedef int				GLsizei;
+typedef void			GLvoid;
+
+#define GL_ZERO							0
+#define GL_ONE							1
+#define GL_TRUE							1
+#define GL_POINTS						0x0000
+#define GL_TRIANGLES					0x0004
+#define GL_QUADS						0x0007
+#define GL_SRC_COLOR					0x0300
+#define GL_ONE_MINUS_SRC_COLOR			0x0301
+#define GL_SRC_ALPHA					0x0302
+#define GL_ONE_MINUS_SRC_ALPHA			0x0303
+#define GL_DST_ALPHA					0x0304
+#define GL_ONE_MINUS_DST_ALPHA			0x0305
+#define GL_DST_COLOR					0x0306
+#define GL_ONE_MINUS_DST_COLOR			0x0307
+#define GL_SRC_ALPHA_SATURATE			0x0308
+#define GL_BLEND						0x0BE2
+#define GL_TEXTURE_2D					0x0DE1
+#define GL_UNSIGNED_BYTE				0x1401
+#define GL_UNSIGNED_SHORT				0x1403
+#define GL_FLOAT						0x1406
+#define GL_MODELVIEW					0x1700
+#define GL_TEXTURE						0x1702
+#define GL_RGB							0x1907
+#define GL_RGBA							0x1908
+#define GL_LUMINANCE					0x1909
+#define GL_VERTEX_ARRAY					0x8074
+#define GL_COLOR_ARRAY					0x8076
+#define GL_TEXTURE_COORD_ARRAY			0x8078
+#define GL_TEXTURE_RECTANGLE_ARB		0x84F5
+#define GL_POINT_SPRITE					0x8861
+#define GL_COORD_REPLACE				0x8862
+#define GL_ARRAY_BUFFER					0x8892
+#define GL_DYNAMIC_DRAW					0x88E8
+
+void	glEnable( GLenum cap );
+void	glDisable( GLenum cap );
+void	glBlendFunc( GLenum source, GLenum destination );
+void	glPushMatrix();
+void	glPopMatrix();
+void	glTranslatef( GLfloat x, GLfloat y, GLfloat z );
+void	glScalef( GLfloat x, GLfloat y, GLfloat z );
+void	glMatrixMode( GLenum mode );
+void	glLoadIdentity();
+void	glGenBuffers( GLsizei n, GLuint* buffers );
+void	glDeleteBuffers( GLsizei n, const GLuint* buffers );
+void	glBindBuffer( GLenum target, GLuint buffer );
+void	glBufferData( GLenum target, GLsizei size, const GLvoid* data, GLenum usage );
+void	glBindTexture( GLenum target, GLuint texture );
+void	glTexEnvi( GLenum target, GLenum name, GLint value );
+void	glEnableClientState( GLenum array );
+void	glDisableClientState( GLenum array );
+void	glVertexPointer( GLint size, GLenum type, GLsizei stride, const GLvoid* pointer );
+void	glTexCoordPointer( GLint size, GLenum type, GLsizei stride, const GLvoid* pointer );
+void	glColorPointer( GLint size, GLenum type, GLsizei stride, const GLvoid* pointer );
+void	glDrawArrays( GLenum mode, GLint first, GLsizei count );
+void	glDrawElements( GLenum mode, GLsizei count, GLenum type, const GLvoid* indices );
+
+// ------------------------------------------------------------------------
+// openFrameworks
+// ------------------------------------------------------------------------
+
+enum ofLogLevel
+{
+	OF_LOG_VERBOSE,
+	OF_LOG_NOTICE,
+	OF_LOG_WARNING,
+	OF_LOG_ERROR,
+	OF_LOG_FATAL_ERROR,
+	OF_LOG_SILENT
+};
+
+#define OF_IMAGE_GRAYSCALE		0x00
+#define OF_IMAGE_COLOR			0x01
+#define OF_IMAGE_COLOR_ALPHA	0x02
+
+void		ofLog( int level, std::string message );
+void		ofSetLogLevel( int level );
+float		ofRandom( float min, float max );
+void		ofSeedRandom( int seed );
+int			ofGetElapsedTimeMillis();
+float		ofGetElapsedTimef();
+float		ofGetFrameRate();
+std::string	ofToDataPath( std::string path, bool absolute = false );
+void		ofSetColor( int r, int g, int b, int a );
+void		ofSetColor( int r, int g, int b );
+
+template <class T> std::string ofToString( const T& value )
+{
+	std::ostringstream out;
+	out << value;
+	return out.str();
+}
+
+// Freeze the clock at millis, or let it run again with a negative value
+void		ofStubSetElapsedTimeMillis( int millis );
+
+// ofGetFrameRate() reports rate, 60 until set
+void		ofStubSetFrameRate( float rate );
+
+// Every ofTexture::allocate() gets a new texture id.  Allocations and uploads from a
+// thread other than the one that last called ofStubSetGLThread() are counted
+int			ofStubGetNumTexturesAllocated();
+void		ofStubSetGLThread();
+int			ofStubGetNumOffThreadGLCalls();
+
+typedef struct
+{
+	GLuint	textureID;
+	int		textureTarget;
+	float	tex_t, tex_u;
+	float	tex_w, tex_h;
+	float	width, height;
+	bool	bFlipTexture;
+} ofTextureData;
+
+class ofTexture
+{
+public:
+	ofTexture();
+	void			allocate( int w, int h, int internalGlDataType );
+	void			loadData( unsigned char* data, int w, int h, int glDataType );
+	void			clear();
+	void			draw( float x, float y, float w, float h );
+	ofTextureData	getTextureData() { return texData; }
+	ofTextureData	texData;
+};
+
+class ofImage
+{
+public:
+	ofImage();
+	bool			loadImage( std::string fileName );
+	void			setUseTexture( bool use ) {}
+	void			setAnchorPercent( float x, float y ) {}
+	ofTexture&		getTextureReference() { return tex; }
+	void			update() { tex.loadData( getPixels(), width, height, GL_RGBA ); }
+	void			draw( float x, float y, float w, float h ) {}
+	unsigned char*	getPixels() { return pixels.empty() ? NULL : &pixels[0]; }
+	void			clear() { pixels.clear(); }
+	int				width, height, bpp, type;
+protected:
+	std::vector<unsigned char>	pixels;
+	ofTexture					tex;
+};
+
+#endif
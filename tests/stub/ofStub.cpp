@@ -0,0 +1,354 @@
+//
+// ofStub.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ofMain.h"
+#include "ofxXmlSettings.h"
+
+#include <sys/time.h>
+#include <pthread.h>
+
+// ------------------------------------------------------------------------
+// GL
+// ------------------------------------------------------------------------
+
+void glEnable( GLenum cap ) {}
+void glDisable( GLenum cap ) {}
+void glBlendFunc( GLenum source, GLenum destination ) {}
+void glPushMatrix() {}
+void glPopMatrix() {}
+void glTranslatef( GLfloat x, GLfloat y, GLfloat z ) {}
+void glScalef( GLfloat x, GLfloat y, GLfloat z ) {}
+void glMatrixMode( GLenum mode ) {}
+void glLoadIdentity() {}
+void glGenBuffers( GLsizei n, GLuint* buffers ) { for ( int i = 0; i < n; i++ ) buffers[i] = i + 1; }
+void glDeleteBuffers( GLsizei n, const GLuint* buffers ) {}
+void glBindBuffer( GLenum target, GLuint buffer ) {}
+void glBufferData( GLenum target, GLsizei size, const GLvoid* data, GLenum usage ) {}
+void glBindTexture( GLenum target, GLuint texture ) {}
+void glTexEnvi( GLenum target, GLenum name, GLint value ) {}
+void glEnableClientState( GLenum array ) {}
+void glDisableClientState( GLenum array ) {}
+void glVertexPointer( GLint size, GLenum type, GLsizei stride, const GLvoid* pointer ) {}
+void glTexCoordPointer( GLint size, GLenum type, GLsizei stride, const GLvoid* pointer ) {}
+void glColorPointer( GLint size, GLenum type, GLsizei stride, const GLvoid* pointer ) {}
+void glDrawArrays( GLenum mode, GLint first, GLsizei count ) {}
+void glDrawElements( GLenum mode, GLsizei count, GLenum type, const GLvoid* indices ) {}
+
+// ------------------------------------------------------------------------
+// openFrameworks
+// ------------------------------------------------------------------------
+
+static int logLevel = OF_LOG_WARNING;
+static int frozenMillis = -1;
+
+void ofLog( int level, std::string message )
+{
+	if ( level >= logLevel )
+		fprintf( stderr, "%s\n", message.c_str() );
+}
+
+void ofSetLogLevel( int level )
+{
+	logLevel = level;
+}
+
+float ofRandom( float min, float max )
+{
+	return min + ( max - min ) * ( rand() / ( RAND_MAX + 1.0f ) );
+}
+
+void ofSeedRandom( int seed )
+{
+	srand( seed );
+}
+
+static int realMillis()
+{
+	static timeval start;
+	static bool started = false;
+	if ( !started )
+	{
+		gettimeofday( &start, NULL );
+		started = true;
+	}
+	
+	timeval now;
+	gettimeofday( &now, NULL );
+	return ( now.tv_sec - start.tv_sec ) * 1000 + ( now.tv_usec - start.tv_usec ) / 1000;
+}
+
+int ofGetElapsedTimeMillis()
+{
+	return frozenMillis >= 0 ? frozenMillis : realMillis();
+}
+
+float ofGetElapsedTimef()
+{
+	return ofGetElapsedTimeMillis() / 1000.0f;
+}
+
+void ofStubSetElapsedTimeMillis( int millis )
+{
+	frozenMillis = millis;
+}
+
+static int numTexturesAllocated = 0;
+static int numOffThreadGLCalls = 0;
+static bool glThreadSet = false;
+static pthread_t glThread;
+
+int ofStubGetNumTexturesAllocated()
+{
+	return numTexturesAllocated;
+}
+
+void ofStubSetGLThread()
+{
+	glThread = pthread_self();
+	glThreadSet = true;
+}
+
+int ofStubGetNumOffThreadGLCalls()
+{
+	return numOffThreadGLCalls;
+}
+
+static void checkGLThread()
+{
+	if ( glThreadSet && !pthread_equal( glThread, pthread_self() ) )
+		numOffThreadGLCalls++;
+}
+
+static float frameRate = 60.0f;
+
+void ofStubSetFrameRate( float rate )
+{
+	frameRate = rate;
+}
+
+float ofGetFrameRate()
+{
+	return frameRate;
+}
+
+std::string ofToDataPath( std::string path, bool absolute )
+{
+	return path;
+}
+
+void ofSetColor( int r, int g, int b, int a ) {}
+void ofSetColor( int r, int g, int b ) {}
+
+ofTexture::ofTexture()
+{
+	memset( &texData, 0, sizeof( texData ) );
+	texData.textureTarget = GL_TEXTURE_2D;
+	texData.tex_t = texData.tex_u = 1.0f;
+}
+
+void ofTexture::allocate( int w, int h, int internalGlDataType )
+{
+	checkGLThread();
+	texData.textureID = ++numTexturesAllocated;
+	texData.width = texData.tex_w = w;
+	texData.height = texData.tex_h = h;
+}
+
+void ofTexture::loadData( unsigned char* data, int w, int h, int glDataType )
+{
+	checkGLThread();
+}
+void ofTexture::clear() {}
+void ofTexture::draw( float x, float y, float w, float h ) {}
+
+ofImage::ofImage()
+{
+	width = height = bpp = 0;
+	type = OF_IMAGE_COLOR_ALPHA;
+}
+
+// Every image is an 8x8 white disc on a transparent background
+bool ofImage::loadImage( std::string fileName )
+{
+	if ( fileName.empty() )
+		return false;
+	
+	width = height = 8;
+	bpp = 32;
+	type = OF_IMAGE_COLOR_ALPHA;
+	pixels.assign( width * height * 4, 255 );
+	for ( int y = 0; y < height; y++ )
+	{
+		for ( int x = 0; x < width; x++ )
+		{
+			float dx = x - 3.5f, dy = y - 3.5f;
+			pixels[( y * width + x ) * 4 + 3] = ( dx * dx + dy * dy < 16.0f ) ? 255 : 0;
+		}
+	}
+	return true;
+}
+
+// ------------------------------------------------------------------------
+// ofxXmlSettings
+// ------------------------------------------------------------------------
+
+ofxXmlSettings::ofxXmlSettings()
+{
+	level = 0;
+}
+
+bool ofxXmlSettings::loadFile( const std::string& filename )
+{
+	std::ifstream file( filename.c_str(), std::ios::binary );
+	if ( !file.good() )
+		return false;
+	
+	std::ostringstream buffer;
+	buffer << file.rdbuf();
+	return loadFromBuffer( buffer.str() );
+}
+
+static bool isNameChar( char c )
+{
+	return isalnum( (unsigned char)c ) || c == '_' || c == '-' || c == ':' || c == '.';
+}
+
+bool ofxXmlSettings::loadFromBuffer( std::string buffer )
+{
+	names.clear();
+	attributes.clear();
+	level = 0;
+	
+	size_t length = buffer.size();
+	size_t i = 0;
+	while ( ( i = buffer.find( '<', i ) ) != std::string::npos )
+	{
+		i++;
+		
+		// Skip closing tags, declarations and comments
+		if ( i >= length || !isNameChar( buffer[i] ) )
+			continue;
+		
+		size_t start = i;
+		while ( i < length && isNameChar( buffer[i] ) )
+			i++;
+		
+		names.push_back( buffer.substr( start, i - start ) );
+		attributes.push_back( Attributes() );
+		Attributes& element = attributes.back();
+		
+		// name="value" pairs up to the end of the tag
+		while ( i < length && buffer[i] != '>' )
+		{
+			if ( !isNameChar( buffer[i] ) )
+			{
+				i++;
+				continue;
+			}
+			
+			start = i;
+			while ( i < length && isNameChar( buffer[i] ) )
+				i++;
+			std::string name = buffer.substr( start, i - start );
+			
+			while ( i < length && isspace( (unsigned char)buffer[i] ) )
+				i++;
+			if ( i >= length || buffer[i] != '=' )
+				continue;
+			i++;
+			while ( i < length && isspace( (unsigned char)buffer[i] ) )
+				i++;
+			if ( i >= length || ( buffer[i] != '"' && buffer[i] != '\'' ) )
+				continue;
+			
+			char quote = buffer[i++];
+			size_t end = buffer.find( quote, i );
+			if ( end == std::string::npos )
+				return false;
+			element[name] = buffer.substr( i, end - i );
+			i = end + 1;
+		}
+	}
+	
+	return !names.empty();
+}
+
+bool ofxXmlSettings::pushTag( const std::string& tag, int which )
+{
+	if ( !tagExists( tag, which ) )
+		return false;
+	
+	level++;
+	return true;
+}
+
+int ofxXmlSettings::popTag()
+{
+	if ( level > 0 )
+		level--;
+	return level;
+}
+
+int ofxXmlSettings::getNumTags( const std::string& tag )
+{
+	return std::count( names.begin(), names.end(), tag );
+}
+
+bool ofxXmlSettings::tagExists( const std::string& tag, int which )
+{
+	return getNumTags( tag ) > which;
+}
+
+const ofxXmlSettings::Attributes* ofxXmlSettings::find( const std::string& tag, int which )
+{
+	for ( size_t i = 0; i < names.size(); i++ )
+	{
+		if ( names[i] == tag && which-- == 0 )
+			return &attributes[i];
+	}
+	return NULL;
+}
+
+int ofxXmlSettings::getAttribute( const std::string& tag, const std::string& attribute, int defaultValue, int which )
+{
+	const Attributes* element = find( tag, which );
+	if ( element == NULL || element->find( attribute ) == element->end() )
+		return defaultValue;
+	return (int)strtol( element->find( attribute )->second.c_str(), NULL, 10 );
+}
+
+double ofxXmlSettings::getAttribute( const std::string& tag, const std::string& attribute, double defaultValue, int which )
+{
+	const Attributes* element = find( tag, which );
+	if ( element == NULL || element->find( attribute ) == element->end() )
+		return defaultValue;
+	return strtod( element->find( attribute )->second.c_str(), NULL );
+}
+
+std::string ofxXmlSettings::getAttribute( const std::string& tag, const std::string& attribute, const std::string& defaultValue, int which )
+{
+	const Attributes* element = find( tag, which );
+	if ( element == NULL || element->find( attribute ) == element->end() )
+		return defaultValue;
+	return element->find( attribute )->second;
+}
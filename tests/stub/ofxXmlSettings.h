@@ -0,0 +1,65 @@
+//
+// ofxXmlSettings.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Stand-in for ofxXmlSettings that understands the flat XML of a .pex file, every
+// element is looked up by name no matter how deep it is.  Attribute values are read
+// with strtod()/strtol() so "nan" and "inf" come through like a hostile file would.
+
+#ifndef _OFX_XML_SETTINGS_STUB
+#define _OFX_XML_SETTINGS_STUB
+
+#include <string>
+#include <vector>
+#include <map>
+
+class ofxXmlSettings
+{
+	
+public:
+	
+	ofxXmlSettings();
+	
+	bool		loadFile( const std::string& filename );
+	bool		loadFromBuffer( std::string buffer );
+	
+	bool		pushTag( const std::string& tag, int which = 0 );
+	int			popTag();
+	int			getNumTags( const std::string& tag );
+	bool		tagExists( const std::string& tag, int which = 0 );
+	
+	int			getAttribute( const std::string& tag, const std::string& attribute, int defaultValue, int which = 0 );
+	double		getAttribute( const std::string& tag, const std::string& attribute, double defaultValue, int which = 0 );
+	std::string	getAttribute( const std::string& tag, const std::string& attribute, const std::string& defaultValue, int which = 0 );
+	
+protected:
+	
+	typedef std::map<std::string, std::string> Attributes;
+	
+	const Attributes*	find( const std::string& tag, int which );
+	
+	std::vector<std::string>	names;
+	std::vector<Attributes>		attributes;
+	int							level;
+};
+
+#endif
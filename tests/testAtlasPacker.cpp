@@ -0,0 +1,161 @@
+//
+// testAtlasPacker.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Checks that ofxParticleAtlasPacker places the same rectangles the same way every
+// time, keeps padded rectangles inside their page and apart, moves on to new pages as
+// pages fill up and fails cleanly on rectangles that can't fit any page
+
+#include "ofxParticleAtlas.h"
+#include "testUtil.h"
+
+#define TEST_RECTS		300
+#define TEST_PAGE_SIZE	256
+#define TEST_PADDING	2
+
+// Add TEST_RECTS rectangles of random sizes, the same ones for the same seed
+static void addRects( ofxParticleAtlasPacker& packer, std::vector<int>& widths, std::vector<int>& heights, GLuint seed )
+{
+	widths.clear();
+	heights.clear();
+	for ( int i = 0; i < TEST_RECTS; i++ )
+	{
+		int w = 1 + (int)( Xorshift32Random0To1( seed ) * 63 );
+		int h = 1 + (int)( Xorshift32Random0To1( seed ) * 63 );
+		TEST_CHECK( packer.add( w, h ) == i );
+		widths.push_back( w );
+		heights.push_back( h );
+	}
+}
+
+static void testDeterministic()
+{
+	ofxParticleAtlasPacker first( TEST_PAGE_SIZE, TEST_PADDING ), second( TEST_PAGE_SIZE, TEST_PADDING );
+	std::vector<int> widths, heights;
+	
+	addRects( first, widths, heights, 99 );
+	addRects( second, widths, heights, 99 );
+	TEST_CHECK( first.pack() );
+	TEST_CHECK( second.pack() );
+	TEST_CHECK( first.getNumPages() > 1 && first.getNumPages() == second.getNumPages() );
+	
+	// Packing again after clear() gives the same result too
+	first.clear();
+	TEST_CHECK( first.getNumPages() == 0 );
+	addRects( first, widths, heights, 99 );
+	TEST_CHECK( first.pack() );
+	
+	for ( int i = 0; i < TEST_RECTS; i++ )
+	{
+		int page1, x1, y1, page2, x2, y2;
+		first.getPixelRect( i, page1, x1, y1 );
+		second.getPixelRect( i, page2, x2, y2 );
+		TEST_CHECK( page1 == page2 && x1 == x2 && y1 == y2 );
+	}
+}
+
+static void testNoOverlap()
+{
+	ofxParticleAtlasPacker packer( TEST_PAGE_SIZE, TEST_PADDING );
+	std::vector<int> widths, heights;
+	addRects( packer, widths, heights, 1234 );
+	TEST_CHECK( packer.pack() );
+	
+	std::vector<int> pages( TEST_RECTS ), xs( TEST_RECTS ), ys( TEST_RECTS );
+	for ( int i = 0; i < TEST_RECTS; i++ )
+	{
+		packer.getPixelRect( i, pages[i], xs[i], ys[i] );
+		TEST_CHECK( pages[i] >= 0 && pages[i] < packer.getNumPages() );
+		
+		// The padding fits inside the page
+		TEST_CHECK( xs[i] >= TEST_PADDING && ys[i] >= TEST_PADDING );
+		TEST_CHECK( xs[i] + widths[i] + TEST_PADDING <= TEST_PAGE_SIZE );
+		TEST_CHECK( ys[i] + heights[i] + TEST_PADDING <= TEST_PAGE_SIZE );
+		
+		AtlasRegion region = packer.getRegion( i );
+		TEST_CHECK( region.page == pages[i] );
+		TEST_CHECK( region.u1 == (GLfloat)xs[i] / TEST_PAGE_SIZE && region.v2 == (GLfloat)( ys[i] + heights[i] ) / TEST_PAGE_SIZE );
+	}
+	
+	// Rectangles on the same page are at least two paddings apart
+	int overlaps = 0;
+	for ( int i = 0; i < TEST_RECTS; i++ )
+	{
+		for ( int j = i + 1; j < TEST_RECTS; j++ )
+		{
+			if ( pages[i] != pages[j] ) continue;
+			
+			bool apartX = xs[i] + widths[i] + TEST_PADDING * 2 <= xs[j] || xs[j] + widths[j] + TEST_PADDING * 2 <= xs[i];
+			bool apartY = ys[i] + heights[i] + TEST_PADDING * 2 <= ys[j] || ys[j] + heights[j] + TEST_PADDING * 2 <= ys[i];
+			if ( !apartX && !apartY )
+				overlaps++;
+		}
+	}
+	TEST_CHECK( overlaps == 0 );
+	printf( "  %d rectangles on %d pages\n", TEST_RECTS, packer.getNumPages() );
+}
+
+static void testFullPages()
+{
+	// Four padded 32x32 rectangles fill a 64 pixel page, the rest go to new pages
+	ofxParticleAtlasPacker packer( 64, 1 );
+	for ( int i = 0; i < 10; i++ )
+		packer.add( 30, 30 );
+	TEST_CHECK( packer.pack() );
+	TEST_CHECK( packer.getNumPages() == 3 );
+	
+	int page, x, y;
+	packer.getPixelRect( 3, page, x, y );
+	TEST_CHECK( page == 0 && x == 33 && y == 33 );
+	packer.getPixelRect( 4, page, x, y );
+	TEST_CHECK( page == 1 && x == 1 && y == 1 );
+	packer.getPixelRect( 9, page, x, y );
+	TEST_CHECK( page == 2 );
+	
+	// A rectangle that fits no page fails the pack but the others are still placed
+	packer.clear();
+	packer.add( 30, 30 );
+	int tooBig = packer.add( 63, 10 );
+	packer.add( 30, 30 );
+	TEST_CHECK( !packer.pack() );
+	
+	packer.getPixelRect( tooBig, page, x, y );
+	TEST_CHECK( page == -1 );
+	TEST_CHECK( packer.getRegion( tooBig ).page == -1 );
+	packer.getPixelRect( 0, page, x, y );
+	TEST_CHECK( page == 0 );
+	packer.getPixelRect( 2, page, x, y );
+	TEST_CHECK( page == 0 );
+	TEST_CHECK( packer.getNumPages() == 1 );
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_SILENT );
+	
+	testDeterministic();
+	testNoOverlap();
+	testFullPages();
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
@@ -0,0 +1,166 @@
+//
+// testGroup.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Checks that ofxParticleGroup ignores handles of removed sources, even once their slot
+// has been reused, that the whole pool is drawn with one batch and that stalls and a
+// clock going backwards don't empty or flood the pool
+
+#include "ofxParticleGroup.h"
+#include "testUtil.h"
+
+static void testDeadHandles()
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	ofxParticleEmitter config;
+	TEST_CHECK( config.loadConfigFromString( testConfig( 100, 1.0f, 0.0f ) ) );
+	config.finishLoading();
+	
+	ofxParticleGroup group;
+	group.setup( &config, 1000 );
+	
+	Vector2f origin = Vector2fMake( 0.0f, 0.0f );
+	int removed = group.addSource( origin );
+	group.removeSource( removed );
+	group.removeSource( removed );
+	TEST_CHECK( group.getNumSources() == 0 );
+	
+	// Both reuse slots, the first one the removed source's
+	int first = group.addSource( origin, false );
+	int second = group.addSource( origin, false );
+	TEST_CHECK( first != removed && second != removed && first != second );
+	TEST_CHECK( group.getNumSources() == 2 );
+	
+	// None of these may wake the inactive sources up
+	group.setSource( removed, origin, true );
+	ParticleEmitterUpdate update = { removed, origin, 1 };
+	group.updateSources( &update, 1 );
+	group.removeSource( removed );
+	TEST_CHECK( group.getNumSources() == 2 );
+	
+	ofStubSetElapsedTimeMillis( 100 );
+	group.update();
+	TEST_CHECK( group.getParticleCount() == 0 );
+	
+	// A live handle still works
+	group.setSource( first, origin, true );
+	ofStubSetElapsedTimeMillis( 200 );
+	group.update();
+	TEST_CHECK( group.getParticleCount() > 0 );
+	
+	group.exit();
+	config.exit();
+}
+
+static void testDrawCalls()
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	ofxParticleEmitter config;
+	TEST_CHECK( config.loadConfigFromString( testConfig( 1000, 10.0f, 0.0f ) ) );
+	config.finishLoading();
+	
+	ofxParticleGroup group;
+	group.setup( &config, 20000 );
+	for ( int i = 0; i < 100; i++ )
+		group.addSource( Vector2fMake( i, 0.0f ) );
+	
+	// 100 sources at 100 particles a second each
+	ofStubSetElapsedTimeMillis( 1000 );
+	group.update();
+	group.draw();
+	TEST_CHECK( group.getParticleCount() > 5000 && group.getParticleCount() <= 16384 );
+	TEST_CHECK( group.getNumDrawCalls() == 1 );
+	
+	// Past the 16-bit index limit the batch has to split
+	ofStubSetElapsedTimeMillis( 2000 );
+	group.update();
+	group.draw();
+	TEST_CHECK( group.getParticleCount() > 16384 );
+	TEST_CHECK( group.getNumDrawCalls() == 2 );
+	printf( "  %d particles in %d draw calls\n", group.getParticleCount(), group.getNumDrawCalls() );
+	
+	group.exit();
+	config.exit();
+}
+
+static void testStall()
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	ofxParticleEmitter config;
+	TEST_CHECK( config.loadConfigFromString( testConfig( 100, 1.0f, 0.0f ) ) );
+	config.finishLoading();
+	
+	ofxParticleGroup group;
+	group.setup( &config, 1000 );
+	int handles[4];
+	for ( int i = 0; i < 4; i++ )
+		handles[i] = group.addSource( Vector2fMake( i * 100.0f, 0.0f ) );
+	
+	int millis = 0;
+	for ( int frame = 0; frame < 30; frame++ )
+	{
+		millis += 16;
+		ofStubSetElapsedTimeMillis( millis );
+		group.update();
+	}
+	
+	// Ten seconds without an update.  Every source spawns its last lifespan's worth aged by
+	// when each was due, which is 100 particles with no lifespan variance
+	millis += 10000;
+	ofStubSetElapsedTimeMillis( millis );
+	group.update();
+	int afterStall = group.getParticleCount();
+	TEST_CHECK( afterStall == 400 );
+	
+	// Their ages are spread over the lifespan, so with the sources off a quarter of them die
+	// in the next quarter second
+	for ( int i = 0; i < 4; i++ )
+		group.setSource( handles[i], Vector2fMake( i * 100.0f, 0.0f ), false );
+	millis += 250;
+	ofStubSetElapsedTimeMillis( millis );
+	group.update();
+	TEST_CHECK( group.getParticleCount() > 250 && group.getParticleCount() < 350 );
+	
+	// Going back in time neither spawns nor kills particles
+	int beforeRewind = group.getParticleCount();
+	millis -= 5000;
+	ofStubSetElapsedTimeMillis( millis );
+	group.update();
+	TEST_CHECK( group.getParticleCount() == beforeRewind );
+	
+	printf( "  %d particles after a stall, %d after rewinding the clock\n", afterStall, group.getParticleCount() );
+	
+	group.exit();
+	config.exit();
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_ERROR );
+	
+	testDeadHandles();
+	testDrawCalls();
+	testStall();
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
@@ -0,0 +1,146 @@
+//
+// testLoader.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Checks that ofxParticleEmitterLoader decodes on its worker thread but only uploads
+// textures from update(), one emitter per call when the budget is used up, and that the
+// handles returned by load() report each load finishing or failing
+
+#include "ofxParticleEmitterLoader.h"
+#include "testUtil.h"
+
+#include <unistd.h>
+
+#define TEST_EMITTERS	4
+
+// Wait for the worker thread to decode count loads, at most a few seconds
+static bool waitForDecoded( ofxParticleEmitterLoader& loader, int count )
+{
+	for ( int i = 0; i < 5000 && loader.getNumDecoded() < count; i++ )
+		usleep( 1000 );
+	return loader.getNumDecoded() == count;
+}
+
+static void testUploadOrdering()
+{
+	ofStubSetGLThread();
+	ofStubSetElapsedTimeMillis( 0 );
+	int texturesBefore = ofStubGetNumTexturesAllocated();
+	
+	ofxParticleEmitter emitters[TEST_EMITTERS + 1];
+	int handles[TEST_EMITTERS + 1];
+	
+	ofxParticleEmitterLoader loader;
+	for ( int i = 0; i < TEST_EMITTERS; i++ )
+	{
+		std::string filename = "build/testLoader" + ofToString( i ) + ".pex";
+		TEST_CHECK( testWriteFile( filename, testConfig( 100 + i, 1.0f, 0.0f ) ) );
+		handles[i] = loader.load( &emitters[i], filename );
+	}
+	handles[TEST_EMITTERS] = loader.load( &emitters[TEST_EMITTERS], "build/testLoaderMissing.pex" );
+	TEST_CHECK( loader.load( NULL, "build/testLoader0.pex" ) == -1 );
+	
+	// Decoding mustn't touch GL or finish loading
+	TEST_CHECK( waitForDecoded( loader, TEST_EMITTERS + 1 ) );
+	TEST_CHECK( ofStubGetNumTexturesAllocated() == texturesBefore );
+	for ( int i = 0; i <= TEST_EMITTERS; i++ )
+	{
+		TEST_CHECK( !emitters[i].isLoaded() );
+		TEST_CHECK( loader.getLoadState( handles[i] ) == kEmitterLoadPending );
+	}
+	
+	// With no budget left every update() finishes exactly one load, in the order queued
+	for ( int i = 0; i <= TEST_EMITTERS; i++ )
+	{
+		loader.update( 0 );
+		TEST_CHECK( loader.getNumDecoded() == TEST_EMITTERS - i );
+		
+		for ( int j = 0; j <= TEST_EMITTERS; j++ )
+		{
+			int state = loader.getLoadState( handles[j] );
+			if ( j > i )
+				TEST_CHECK( state == kEmitterLoadPending );
+			else if ( j < TEST_EMITTERS )
+				TEST_CHECK( state == kEmitterLoadDone );
+			else
+				TEST_CHECK( state == kEmitterLoadFailed );
+			
+			// An emitter is loaded exactly when its texture has been uploaded
+			bool uploaded = emitters[j].getTexture() != NULL &&
+				emitters[j].getTexture()->getTextureReference().getTextureData().textureID != 0;
+			TEST_CHECK( emitters[j].isLoaded() == ( state == kEmitterLoadDone ) );
+			TEST_CHECK( uploaded == ( state == kEmitterLoadDone ) );
+		}
+	}
+	
+	TEST_CHECK( ofStubGetNumTexturesAllocated() == texturesBefore + TEST_EMITTERS );
+	TEST_CHECK( emitters[1].maxParticles == 101 );
+	TEST_CHECK( loader.isIdle() );
+	TEST_CHECK( loader.getLoadState( 1000 ) == kEmitterLoadFailed );
+	
+	loader.exit();
+	for ( int i = 0; i <= TEST_EMITTERS; i++ )
+		emitters[i].exit();
+}
+
+// While the budget lasts update() keeps uploading
+static void testBudget()
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	
+	ofxParticleEmitter emitters[TEST_EMITTERS];
+	int handles[TEST_EMITTERS];
+	
+	ofxParticleEmitterLoader loader;
+	for ( int i = 0; i < TEST_EMITTERS; i++ )
+		handles[i] = loader.load( &emitters[i], "build/testLoader" + ofToString( i ) + ".pex" );
+	TEST_CHECK( waitForDecoded( loader, TEST_EMITTERS ) );
+	
+	// The clock is frozen so the budget never runs out
+	loader.update( 2 );
+	for ( int i = 0; i < TEST_EMITTERS; i++ )
+	{
+		TEST_CHECK( emitters[i].isLoaded() );
+		TEST_CHECK( loader.getLoadState( handles[i] ) == kEmitterLoadDone );
+	}
+	
+	// Loads still queued when the loader exits have failed
+	int handle = loader.load( &emitters[0], "build/testLoader0.pex" );
+	loader.exit();
+	TEST_CHECK( loader.getLoadState( handle ) == kEmitterLoadFailed );
+	
+	for ( int i = 0; i < TEST_EMITTERS; i++ )
+		emitters[i].exit();
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_SILENT );
+	
+	testUploadOrdering();
+	testBudget();
+	
+	TEST_CHECK( ofStubGetNumOffThreadGLCalls() == 0 );
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
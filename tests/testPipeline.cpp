@@ -0,0 +1,150 @@
+//
+// testPipeline.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Stress test for ofxParticlePipeline.  The GL thread side checks that frames only move
+// forward and that the front buffer never changes while it is being read, and that a
+// stopped emitter publishes empty frames rather than stale or unwritten buffers
+
+#include "ofxParticlePipeline.h"
+#include "testUtil.h"
+
+#include "Poco/Thread.h"
+
+#define TEST_FRAMES		3000
+
+static GLuint checksum( const PointSprite* sprites, int count )
+{
+	// FNV-1a over the raw bytes
+	const unsigned char* bytes = (const unsigned char*)sprites;
+	GLuint hash = 2166136261U;
+	for ( size_t i = 0; i < sizeof( PointSprite ) * count; i++ )
+		hash = ( hash ^ bytes[i] ) * 16777619U;
+	return hash;
+}
+
+static void testFramesAndTearing()
+{
+	ofxParticleEmitter emitter;
+	TEST_CHECK( emitter.loadConfigFromString( testConfig( 2000, 0.5f, 0.25f ) ) );
+	emitter.finishLoading();
+	
+	ofxParticlePipeline pipeline;
+	TEST_CHECK( pipeline.start( &emitter ) );
+	
+	int lastFrame = -1, freshFrames = 0;
+	for ( int i = 0; i < TEST_FRAMES; i++ )
+	{
+		bool fresh = pipeline.update();
+		
+		int frame = pipeline.getFrame();
+		TEST_CHECK( fresh ? frame > lastFrame : frame == lastFrame );
+		lastFrame = frame;
+		freshFrames += fresh;
+		
+		// Read the front buffer twice with the worker running in between
+		const PointSprite* sprites = pipeline.getVertices();
+		int count = pipeline.getParticleCount();
+		TEST_CHECK( count >= 0 && count <= emitter.maxParticles );
+		
+		GLuint before = checksum( sprites, count );
+		if ( i % 4 == 0 )
+			Poco::Thread::yield();
+		GLuint after = checksum( sprites, count );
+		
+		TEST_CHECK( before == after );
+		TEST_CHECK( pipeline.getFrame() == frame && pipeline.getParticleCount() == count );
+	}
+	
+	pipeline.stop();
+	TEST_CHECK( freshFrames > 0 );
+	printf( "  %d of %d frames fresh, last frame %d\n", freshFrames, TEST_FRAMES, lastFrame );
+}
+
+// Waits for a fresh frame, giving up after a second
+static bool waitForFrame( ofxParticlePipeline& pipeline )
+{
+	for ( int i = 0; i < 1000; i++ )
+	{
+		if ( pipeline.update() )
+			return true;
+		Poco::Thread::sleep( 1 );
+	}
+	return false;
+}
+
+static void testStoppedEmitter()
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	
+	// Stopped before the pipeline starts, the buffers were never written
+	ofxParticleEmitter stopped;
+	TEST_CHECK( stopped.loadConfigFromString( testConfig( 500, 1.0f, 0.0f, "<duration value=\"0.1\"/>" ) ) );
+	stopped.finishLoading();
+	stopped.prewarm( 0.5f );
+	TEST_CHECK( !stopped.isActive() );
+	
+	ofxParticlePipeline pipeline;
+	pipeline.start( &stopped );
+	for ( int i = 0; i < 3; i++ )
+	{
+		TEST_CHECK( waitForFrame( pipeline ) );
+		TEST_CHECK( pipeline.getParticleCount() == 0 );
+	}
+	pipeline.stop();
+	
+	// Stops while running, once it has every frame after must be empty
+	ofxParticleEmitter running;
+	TEST_CHECK( running.loadConfigFromString( testConfig( 500, 1.0f, 0.0f, "<duration value=\"0.1\"/>" ) ) );
+	running.finishLoading();
+	
+	pipeline.start( &running );
+	int millis = 0;
+	bool sawParticles = false;
+	for ( int i = 0; i < 20; i++ )
+	{
+		millis += 16;
+		ofStubSetElapsedTimeMillis( millis );
+		TEST_CHECK( waitForFrame( pipeline ) );
+		sawParticles |= pipeline.getParticleCount() > 0;
+	}
+	for ( int i = 0; i < 3; i++ )
+	{
+		TEST_CHECK( waitForFrame( pipeline ) );
+		TEST_CHECK( pipeline.getParticleCount() == 0 );
+	}
+	pipeline.stop();
+	TEST_CHECK( sawParticles );
+	
+	ofStubSetElapsedTimeMillis( -1 );
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_ERROR );
+	
+	testFramesAndTearing();
+	testStoppedEmitter();
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
@@ -0,0 +1,112 @@
+//
+// testProperties.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Property tests over generated configs, most of them hostile: whatever a .pex holds,
+// update() must keep the particle count within bounds, never produce NaN or infinite
+// sprites and take a bounded time however long the frame was
+
+#include "ofxParticleEmitter.h"
+#include "testUtil.h"
+
+#define TEST_CONFIGS			300
+#define TEST_FRAMES				12
+#define TEST_MAXIMUM_UPDATE		0.25	// Seconds, far above a full pool's update
+
+// Frame lengths in milliseconds, including stalls and a clock that went backwards
+static const int frameMillis[TEST_FRAMES] = { 16, 16, 0, 33, 1000, 16, 3600000, 16, -100, 16, 500, 16 };
+
+static void testConfigs()
+{
+	GLuint state = 777;
+	double worst = 0;
+	
+	for ( int i = 0; i < TEST_CONFIGS; i++ )
+	{
+		// Every tenth config asks for a full size pool
+		int maxParticles = ( i % 10 == 0 ) ? MAXIMUM_PARTICLES : 1 + i * 37 % 5000;
+		std::string extra = testHostileConfig( state );
+		
+		ofStubSetElapsedTimeMillis( 0 );
+		ofxParticleEmitter emitter;
+		if ( !emitter.loadConfigFromString( testConfig( maxParticles, 1.0f, 0.5f, extra ) ) )
+			continue;
+		emitter.finishLoading();
+		emitter.sortMode = i % 3;
+		
+		int millis = 0;
+		for ( int frame = 0; frame < TEST_FRAMES; frame++ )
+		{
+			millis += frameMillis[frame];
+			ofStubSetElapsedTimeMillis( millis );
+			
+			double start = testSeconds();
+			emitter.update();
+			double elapsed = testSeconds() - start;
+			worst = MAX( worst, elapsed );
+			
+			if ( !testEmitterIsSane( emitter ) || elapsed > TEST_MAXIMUM_UPDATE )
+			{
+				fprintf( stderr, "config %d frame %d: %d particles, %.1f ms\n  %s\n", i, frame,
+					emitter.getParticleCount(), elapsed * 1000.0, extra.c_str() );
+				TEST_CHECK( testEmitterIsSane( emitter ) );
+				TEST_CHECK( elapsed <= TEST_MAXIMUM_UPDATE );
+				break;
+			}
+		}
+		
+		emitter.exit();
+	}
+	
+	printf( "  %d configs, slowest update %.3f ms\n", TEST_CONFIGS, worst * 1000.0 );
+}
+
+// A long stall can't make update() take longer than filling the pool once, and the
+// particles spawned for it are still alive
+static void testStallIsBounded()
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	ofxParticleEmitter emitter;
+	TEST_CHECK( emitter.loadConfigFromString( testConfig( MAXIMUM_PARTICLES, 2.0f, 1.0f ) ) );
+	emitter.finishLoading();
+	
+	ofStubSetElapsedTimeMillis( 1000000000 );
+	double start = testSeconds();
+	emitter.update();
+	double elapsed = testSeconds() - start;
+	
+	TEST_CHECK( emitter.getParticleCount() > 0 && emitter.getParticleCount() <= MAXIMUM_PARTICLES );
+	TEST_CHECK( testEmitterIsSane( emitter ) );
+	TEST_CHECK( elapsed <= TEST_MAXIMUM_UPDATE );
+	printf( "  11.6 day stall, %d particles in %.3f ms\n", emitter.getParticleCount(), elapsed * 1000.0 );
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_SILENT );
+	
+	testConfigs();
+	testStallIsBounded();
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
@@ -0,0 +1,180 @@
+//
+// testRecorder.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Records an emitter with ofxParticleRecorder and checks that ofxParticlePlayer plays
+// back exactly the recorded sprites and parameters, in any seek order, and copes with
+// recordings that are truncated or corrupt
+
+#include "ofxParticleRecorder.h"
+#include "testUtil.h"
+
+#include <unistd.h>
+
+#define TEST_FILENAME		"build/testRecorder.opr"
+#define TEST_FRAMES			120
+#define TEST_MAX_PARTICLES	300		// Less than the emitter has, so frames get truncated
+
+typedef struct
+{
+	std::vector<PointSprite>	sprites;
+	ParticleRecordParams		params;
+} RecordedFrame;
+
+static std::vector<RecordedFrame> frames;
+
+static bool matches( const ofxParticlePlayer& player )
+{
+	int recorded = player.getRecordedFrame();
+	if ( recorded < 0 || recorded >= (int)frames.size() )
+		return false;
+	
+	const RecordedFrame& frame = frames[recorded];
+	if ( player.getParticleCount() != (int)frame.sprites.size() )
+		return false;
+	if ( memcmp( &player.getParams(), &frame.params, sizeof( frame.params ) ) != 0 )
+		return false;
+	return frame.sprites.empty() ||
+		memcmp( player.getVertices(), &frame.sprites[0], sizeof( PointSprite ) * frame.sprites.size() ) == 0;
+}
+
+static void record()
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	ofxParticleEmitter emitter;
+	TEST_CHECK( emitter.loadConfigFromString( testConfig( 1000, 1.0f, 0.5f ) ) );
+	emitter.finishLoading();
+	
+	ofxParticleRecorder recorder;
+	TEST_CHECK( recorder.start( TEST_FILENAME, TEST_MAX_PARTICLES, 4 ) );
+	
+	for ( int i = 0; i < TEST_FRAMES; i++ )
+	{
+		ofStubSetElapsedTimeMillis( ( i + 1 ) * 16 );
+		emitter.sourcePosition = Vector2fMake( i, 240 - i );
+		emitter.update();
+		recorder.record( emitter );
+		
+		// Give the writer time to keep up most of the time, so the ring wraps around
+		if ( i % 10 != 0 )
+			usleep( 1000 );
+		
+		RecordedFrame frame;
+		int count = MIN( emitter.getParticleCount(), TEST_MAX_PARTICLES );
+		frame.sprites.assign( emitter.getVertices(), emitter.getVertices() + count );
+		frame.params.sourcePosition = emitter.sourcePosition;
+		frame.params.gravity = emitter.gravity;
+		frame.params.angle = emitter.angle;
+		frame.params.speed = emitter.speed;
+		frames.push_back( frame );
+	}
+	
+	recorder.stop();
+	TEST_CHECK( !recorder.isRecording() );
+	TEST_CHECK( recorder.getNumRecordedFrames() + recorder.getNumDroppedFrames() == TEST_FRAMES );
+	TEST_CHECK( recorder.getNumRecordedFrames() > 4 );
+	printf( "  %d frames recorded, %d dropped\n", recorder.getNumRecordedFrames(), recorder.getNumDroppedFrames() );
+	
+	emitter.exit();
+}
+
+static void testPlayback()
+{
+	ofxParticlePlayer player;
+	TEST_CHECK( player.open( TEST_FILENAME ) );
+	
+	int numFrames = player.getNumFrames();
+	TEST_CHECK( numFrames > 0 );
+	
+	// In order, recorded frame numbers only go up
+	int last = -1, mismatches = 0;
+	for ( int i = 0; i < numFrames; i++ )
+	{
+		TEST_CHECK( player.seek( i ) );
+		TEST_CHECK( player.getCurrentFrame() == i );
+		TEST_CHECK( player.getRecordedFrame() > last );
+		last = player.getRecordedFrame();
+		if ( !matches( player ) )
+			mismatches++;
+	}
+	
+	// Backwards and jumping around
+	GLuint state = 5;
+	for ( int i = 0; i < numFrames * 2; i++ )
+	{
+		int frame = ( i % 3 == 0 ) ? numFrames - 1 - i / 2 % numFrames : (int)( Xorshift32Random0To1( state ) * numFrames ) % numFrames;
+		TEST_CHECK( player.seek( frame ) );
+		if ( !matches( player ) )
+			mismatches++;
+	}
+	TEST_CHECK( mismatches == 0 );
+	
+	TEST_CHECK( !player.seek( -1 ) );
+	TEST_CHECK( !player.seek( numFrames ) );
+	player.close();
+}
+
+static void testDamagedFiles()
+{
+	std::ifstream in( TEST_FILENAME, std::ios::binary );
+	std::ostringstream contents;
+	contents << in.rdbuf();
+	std::string data = contents.str();
+	
+	ofxParticlePlayer player;
+	TEST_CHECK( player.open( TEST_FILENAME ) );
+	int numFrames = player.getNumFrames();
+	player.close();
+	
+	// A recording cut off mid frame, as if it was still being written, loses that frame
+	TEST_CHECK( testWriteFile( "build/testRecorderCut.opr", data.substr( 0, data.size() - 10 ) ) );
+	TEST_CHECK( player.open( "build/testRecorderCut.opr" ) );
+	TEST_CHECK( player.getNumFrames() == numFrames - 1 );
+	TEST_CHECK( player.seek( numFrames - 2 ) && matches( player ) );
+	player.close();
+	
+	// Damaged compressed data fails that frame only
+	std::string corrupt = data;
+	corrupt[corrupt.size() - 20] ^= 0x5a;
+	TEST_CHECK( testWriteFile( "build/testRecorderCorrupt.opr", corrupt ) );
+	TEST_CHECK( player.open( "build/testRecorderCorrupt.opr" ) );
+	TEST_CHECK( player.getNumFrames() == numFrames );
+	TEST_CHECK( !player.seek( numFrames - 1 ) );
+	TEST_CHECK( player.seek( 0 ) && matches( player ) );
+	player.close();
+	
+	// Not a recording at all
+	TEST_CHECK( testWriteFile( "build/testRecorderBad.opr", "not a recording" ) );
+	TEST_CHECK( !player.open( "build/testRecorderBad.opr" ) );
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_SILENT );
+	
+	record();
+	testPlayback();
+	testDamagedFiles();
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
@@ -0,0 +1,88 @@
+//
+// testReload.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Checks that reloadFromXml() keeps the live particles, uploads the texture again only
+// when its name changed and resizes the pool when maxParticles changed
+
+#include "ofxParticleEmitter.h"
+#include "testUtil.h"
+
+#define TEST_FILENAME	"build/testReload.pex"
+
+static std::string textureConfig( int maxParticles, const std::string& texture )
+{
+	return testConfig( maxParticles, 5.0f, 0.0f, "<texture name=\"" + texture + "\"/>" );
+}
+
+static GLuint textureID( ofxParticleEmitter& emitter )
+{
+	return emitter.getTexture()->getTextureReference().getTextureData().textureID;
+}
+
+static void testReload()
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	ofxParticleEmitter emitter;
+	TEST_CHECK( testWriteFile( TEST_FILENAME, textureConfig( 500, "a.png" ) ) );
+	TEST_CHECK( emitter.loadFromXml( TEST_FILENAME ) );
+	
+	ofStubSetElapsedTimeMillis( 1000 );
+	emitter.update();
+	int count = emitter.getParticleCount();
+	TEST_CHECK( count > 0 );
+	
+	// Same image, nothing to upload
+	int textures = ofStubGetNumTexturesAllocated();
+	GLuint id = textureID( emitter );
+	TEST_CHECK( emitter.reloadFromXml( TEST_FILENAME ) );
+	TEST_CHECK( ofStubGetNumTexturesAllocated() == textures );
+	TEST_CHECK( textureID( emitter ) == id );
+	TEST_CHECK( emitter.getParticleCount() == count );
+	
+	// A new image has to reach GL even if it was allocated where the old one was
+	TEST_CHECK( testWriteFile( TEST_FILENAME, textureConfig( 500, "b.png" ) ) );
+	TEST_CHECK( emitter.reloadFromXml( TEST_FILENAME ) );
+	TEST_CHECK( emitter.getTextureFilename() == "b.png" );
+	TEST_CHECK( ofStubGetNumTexturesAllocated() == textures + 1 );
+	TEST_CHECK( textureID( emitter ) != 0 && textureID( emitter ) != id );
+	TEST_CHECK( emitter.getParticleCount() == count );
+	
+	// A smaller pool keeps as many particles as fit
+	TEST_CHECK( testWriteFile( TEST_FILENAME, textureConfig( 10, "b.png" ) ) );
+	TEST_CHECK( emitter.reloadFromXml( TEST_FILENAME ) );
+	TEST_CHECK( emitter.maxParticles == 10 );
+	TEST_CHECK( emitter.getParticleCount() == MIN( count, 10 ) );
+	TEST_CHECK( ofStubGetNumTexturesAllocated() == textures + 1 );
+	
+	emitter.exit();
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_ERROR );
+	
+	testReload();
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
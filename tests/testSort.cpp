@@ -0,0 +1,108 @@
+//
+// testSort.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Checks that the age sort keeps the pool ordered by time left to live every frame,
+// including after the order was lost, and that it keeps every particle
+
+#include "ofxParticleEmitter.h"
+#include "testUtil.h"
+
+#define TEST_FRAMES		300
+
+// Opens up the pool so its order can be checked and scrambled
+class SortEmitter : public ofxParticleEmitter
+{
+public:
+	bool isSorted() const
+	{
+		for ( GLint i = 1; i < particleCount; i++ )
+		{
+			if ( particles[i - 1].timeToLive > particles[i].timeToLive )
+				return false;
+		}
+		return true;
+	}
+	
+	GLfloat totalTimeToLive() const
+	{
+		double total = 0;
+		for ( GLint i = 0; i < particleCount; i++ )
+			total += particles[i].timeToLive;
+		return (GLfloat)total;
+	}
+	
+	void reverse()
+	{
+		for ( GLint i = 0, j = particleCount - 1; i < j; i++, j-- )
+		{
+			Particle tmp = particles[i];
+			particles[i] = particles[j];
+			particles[j] = tmp;
+		}
+	}
+};
+
+static void testAgeSort()
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	SortEmitter emitter;
+	TEST_CHECK( emitter.loadConfigFromString( testConfig( 5000, 2.0f, 1.5f ) ) );
+	emitter.finishLoading();
+	emitter.sortMode = kParticleSortAge;
+	
+	int unsorted = 0;
+	int millis = 0;
+	for ( int frame = 0; frame < TEST_FRAMES; frame++ )
+	{
+		// Frame lengths vary so particles die and spawn in uneven batches
+		millis += 5 + frame * 7 % 40;
+		ofStubSetElapsedTimeMillis( millis );
+		emitter.update();
+		if ( !emitter.isSorted() )
+			unsorted++;
+	}
+	TEST_CHECK( unsorted == 0 );
+	TEST_CHECK( emitter.getParticleCount() > 1000 );
+	
+	// Sorting a pool whose order was lost keeps every particle
+	emitter.reverse();
+	emitter.setEmitting( false );
+	GLfloat total = emitter.totalTimeToLive();
+	int count = emitter.getParticleCount();
+	emitter.update();
+	TEST_CHECK( emitter.isSorted() );
+	TEST_CHECK( emitter.getParticleCount() == count );
+	TEST_CHECK( fabsf( emitter.totalTimeToLive() - total ) < total * 0.001f );
+	
+	emitter.exit();
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_ERROR );
+	
+	testAgeSort();
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
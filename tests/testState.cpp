@@ -0,0 +1,129 @@
+//
+// testState.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Checks that emitter state snapshots restore the same particles, and that corrupt or
+// hostile snapshots are rejected without touching the emitter
+
+#include "ofxParticleEmitter.h"
+#include "testUtil.h"
+
+#include <climits>
+
+// Offsets into the snapshot, see ParticleStateHeader in ofxParticleEmitter.cpp
+#define STATE_MAX_PARTICLES		12
+#define STATE_HEADER_SIZE		48
+
+static void loadEmitter( ofxParticleEmitter& emitter, int maxParticles )
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	TEST_CHECK( emitter.loadConfigFromString( testConfig( maxParticles, 2.0f, 0.5f ) ) );
+	emitter.finishLoading();
+	emitter.setRandomSeed( 3 );
+}
+
+static bool sameVertices( const ofxParticleEmitter& a, const ofxParticleEmitter& b )
+{
+	return a.getParticleCount() == b.getParticleCount() &&
+		memcmp( a.getVertices(), b.getVertices(), sizeof( PointSprite ) * a.getParticleCount() ) == 0;
+}
+
+static void testRoundTrip()
+{
+	ofxParticleEmitter source, target;
+	loadEmitter( source, 500 );
+	loadEmitter( target, 500 );
+	source.prewarm( 1.0f );
+	
+	std::vector<unsigned char> state;
+	source.saveState( state );
+	TEST_CHECK( state.size() == STATE_HEADER_SIZE + sizeof( Particle ) * source.getParticleCount() );
+	TEST_CHECK( target.restoreState( state ) );
+	TEST_CHECK( sameVertices( source, target ) );
+	
+	// Both carry on the same way
+	ofStubSetElapsedTimeMillis( 16 );
+	source.update();
+	target.update();
+	TEST_CHECK( sameVertices( source, target ) );
+	
+	// A smaller pool only grows as far as the saved particles need
+	ofxParticleEmitter small;
+	loadEmitter( small, 10 );
+	TEST_CHECK( small.restoreState( state ) );
+	TEST_CHECK( small.maxParticles == small.getParticleCount() );
+	TEST_CHECK( small.maxParticles < 500 );
+	
+	source.exit();
+	target.exit();
+	small.exit();
+}
+
+static void testHostileStates()
+{
+	ofxParticleEmitter source, target;
+	loadEmitter( source, 200 );
+	loadEmitter( target, 100 );
+	source.prewarm( 1.0f );
+	TEST_CHECK( source.getParticleCount() > 0 );
+	
+	std::vector<unsigned char> state;
+	source.saveState( state );
+	
+	// A pool size no config could ask for
+	std::vector<unsigned char> huge = state;
+	GLint maxParticles = INT_MAX;
+	memcpy( &huge[STATE_MAX_PARTICLES], &maxParticles, sizeof( maxParticles ) );
+	TEST_CHECK( !target.restoreState( huge ) );
+	
+	// NaN and infinity in a particle
+	GLfloat bad[2] = { NAN, INFINITY };
+	for ( int i = 0; i < 2; i++ )
+	{
+		std::vector<unsigned char> poisoned = state;
+		size_t offset = STATE_HEADER_SIZE + sizeof( Particle ) * ( source.getParticleCount() / 2 ) + offsetof( Particle, timeToLive );
+		memcpy( &poisoned[offset], &bad[i], sizeof( GLfloat ) );
+		TEST_CHECK( !target.restoreState( poisoned ) );
+	}
+	
+	// Truncated
+	std::vector<unsigned char> truncated( state.begin(), state.end() - 1 );
+	TEST_CHECK( !target.restoreState( truncated ) );
+	
+	// None of them may have changed the emitter
+	TEST_CHECK( target.maxParticles == 100 );
+	TEST_CHECK( target.getParticleCount() == 0 );
+	
+	source.exit();
+	target.exit();
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_SILENT );
+	
+	testRoundTrip();
+	testHostileStates();
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
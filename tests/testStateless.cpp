@@ -0,0 +1,100 @@
+//
+// testStateless.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Checks that ofxParticleStatelessEvaluate() gives the particle ofxParticleEmitter::update()
+// does at a steady frame rate, for both emitter types
+
+#include "ofxParticleEmitter.h"
+#include "ofxParticleStateless.h"
+#include "testUtil.h"
+
+// Offset of the particles in a snapshot, see ParticleStateHeader in ofxParticleEmitter.cpp
+#define STATE_HEADER_SIZE		48
+
+// No variance and no radial or tangential acceleration, which the stateless emitter ignores.
+// Gravity is strong enough that integrating it per update differs visibly from the exact fall
+static const char* steadyConfig = "<sourcePositionVariance x=\"0\" y=\"0\"/><speedVariance value=\"0\"/>"
+	"<angleVariance value=\"0\"/><gravity x=\"30\" y=\"-200\"/>"
+	"<radialAcceleration value=\"0\"/><tangentialAcceleration value=\"0\"/>"
+	"<radialAccelVariance value=\"0\"/><tangentialAccelVariance value=\"0\"/>"
+	"<startParticleSizeVariance value=\"0\"/><FinishParticleSizeVariance value=\"0\"/>";
+
+static const char* radialConfig = "<emitterType value=\"1\"/><rotatePerSecond value=\"90\"/>";
+
+static void testMatchesUpdate( const char* type, const std::string& extra )
+{
+	ofStubSetFrameRate( 50.0f );
+	ofStubSetElapsedTimeMillis( 0 );
+	
+	// A single particle at a time, so the only slot of the stateless config matches it
+	ofxParticleEmitter emitter;
+	TEST_CHECK( emitter.loadConfigFromString( testConfig( 1, 2.0f, 0.0f, extra + steadyConfig ) ) );
+	emitter.finishLoading();
+	
+	ParticleStatelessConfig config;
+	ofxParticleStatelessConfigure( config, emitter, 1, 1 );
+	
+	int checked = 0, mismatched = 0;
+	for ( int frame = 1; frame <= 300; frame++ )
+	{
+		ofStubSetElapsedTimeMillis( frame * 20 );
+		emitter.update();
+		if ( emitter.getParticleCount() != 1 )
+			continue;
+		
+		// The particle's age is taken from a snapshot, the stateless one is evaluated at it
+		std::vector<unsigned char> state;
+		emitter.saveState( state );
+		const Particle* particle = (const Particle*)&state[STATE_HEADER_SIZE];
+		GLfloat age = particle->lifespan - particle->timeToLive;
+		
+		PointSprite sprite;
+		const PointSprite& expected = emitter.getVertices()[0];
+		if ( ofxParticleStatelessEvaluate( config, age, 0, 1, &sprite ) != 1 ||
+			fabsf( sprite.x - expected.x ) > 0.1f || fabsf( sprite.y - expected.y ) > 0.1f ||
+			fabsf( sprite.size - expected.size ) > 0.01f ||
+			fabsf( sprite.color.red - expected.color.red ) > 0.001f ||
+			fabsf( sprite.color.blue - expected.color.blue ) > 0.001f ||
+			fabsf( sprite.color.alpha - expected.color.alpha ) > 0.001f )
+			mismatched++;
+		checked++;
+	}
+	
+	TEST_CHECK( checked > 50 );
+	TEST_CHECK( mismatched == 0 );
+	printf( "  %s: %d of %d frames differ from update()\n", type, mismatched, checked );
+	
+	emitter.exit();
+	ofStubSetFrameRate( 60.0f );
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_ERROR );
+	
+	testMatchesUpdate( "gravity", "" );
+	testMatchesUpdate( "radial", radialConfig );
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
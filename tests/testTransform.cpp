@@ -0,0 +1,174 @@
+//
+// testTransform.cpp
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Checks that ofxParticleTransform refuses cycles, that a parent's change reaches children
+// that were already up to date, and that both simulation spaces place particles where a
+// rotated and scaled parent puts them
+
+#include "ofxParticleEmitter.h"
+#include "ofxParticleTransform.h"
+#include "testUtil.h"
+
+static bool near( const Vector2f& v, GLfloat x, GLfloat y )
+{
+	return fabsf( v.x - x ) < 0.01f && fabsf( v.y - y ) < 0.01f;
+}
+
+static void testCycles()
+{
+	ofxParticleTransform a, b, c;
+	TEST_CHECK( b.setParent( &a ) );
+	TEST_CHECK( c.setParent( &b ) );
+	
+	TEST_CHECK( !a.setParent( &c ) );
+	TEST_CHECK( !a.setParent( &a ) );
+	TEST_CHECK( a.getParent() == NULL );
+	
+	// Moving a node under a sibling of its parent is fine
+	ofxParticleTransform d;
+	TEST_CHECK( d.setParent( &a ) );
+	TEST_CHECK( c.setParent( &d ) );
+	TEST_CHECK( c.getParent() == &d );
+	TEST_CHECK( !d.setParent( &c ) );
+}
+
+static void testVersions()
+{
+	ofxParticleTransform root, left, right, leaf;
+	left.setParent( &root );
+	right.setParent( &root );
+	leaf.setParent( &left );
+	leaf.setPosition( Vector2fMake( 1.0f, 0.0f ) );
+	
+	root.setPosition( Vector2fMake( 10.0f, 0.0f ) );
+	leaf.updateWorld();
+	right.updateWorld();
+	TEST_CHECK( near( Affine2fApply( leaf.getWorldTransform(), Vector2fZero ), 11.0f, 0.0f ) );
+	
+	// Every node is clean now.  The root changes and is brought up to date through the leaf,
+	// the other children only see that its version moved on
+	root.setRotation( 90.0f );
+	leaf.updateWorld();
+	TEST_CHECK( near( Affine2fApply( leaf.getWorldTransform(), Vector2fZero ), 10.0f, 1.0f ) );
+	
+	right.updateWorld();
+	TEST_CHECK( near( Affine2fApply( right.getWorldTransform(), Vector2fMake( 1.0f, 0.0f ) ), 10.0f, 1.0f ) );
+	
+	// The middle node was brought up to date by the leaf, another update leaves it alone
+	Affine2f before = left.getWorldTransform();
+	left.updateWorld();
+	TEST_CHECK( memcmp( &before, &left.getWorldTransform(), sizeof( Affine2f ) ) == 0 );
+	
+	// Reparenting takes the new parent's transform
+	leaf.setParent( &right );
+	right.setScale( 2.0f );
+	leaf.updateWorld();
+	TEST_CHECK( near( Affine2fApply( leaf.getWorldTransform(), Vector2fZero ), 10.0f, 2.0f ) );
+}
+
+// Particles of an emitter at ( 10, 0 ) moving along +x, under a parent rotated by 90 degrees
+// and scaled by 2.  In world coordinates they spawn at ( 100, 70 ) and move along +y
+static const char* spaceConfig = "<sourcePosition x=\"10\" y=\"0\"/><sourcePositionVariance x=\"0\" y=\"0\"/>"
+	"<speed value=\"20\"/><speedVariance value=\"0\"/><angle value=\"0\"/><angleVariance value=\"0\"/>"
+	"<gravity x=\"0\" y=\"0\"/><radialAcceleration value=\"0\"/><tangentialAcceleration value=\"0\"/>"
+	"<radialAccelVariance value=\"0\"/><tangentialAccelVariance value=\"0\"/>"
+	"<startParticleSize value=\"8\"/><startParticleSizeVariance value=\"0\"/>"
+	"<finishParticleSize value=\"8\"/><FinishParticleSizeVariance value=\"0\"/>";
+
+static void testSpace( int space )
+{
+	ofStubSetElapsedTimeMillis( 0 );
+	
+	ofxParticleTransform parent, node;
+	parent.setPosition( Vector2fMake( 100.0f, 50.0f ) );
+	parent.setRotation( 90.0f );
+	parent.setScale( 2.0f );
+	node.setParent( &parent );
+	
+	ofxParticleEmitter emitter;
+	std::string extra = std::string( spaceConfig ) + "<simulationSpace value=\"" + ofToString( space ) + "\"/>";
+	TEST_CHECK( emitter.loadConfigFromString( testConfig( 50, 1.0f, 0.0f, extra ) ) );
+	emitter.finishLoading();
+	emitter.setTransform( &node );
+	
+	int millis = 0;
+	for ( int frame = 0; frame < 30; frame++ )
+	{
+		millis += 16;
+		ofStubSetElapsedTimeMillis( millis );
+		node.updateWorld();
+		emitter.update();
+	}
+	
+	int count = emitter.getParticleCount();
+	int misplaced = 0;
+	for ( int i = 0; i < count; i++ )
+	{
+		const PointSprite& sprite = emitter.getVertices()[i];
+		if ( fabsf( sprite.x - 100.0f ) > 0.01f || sprite.y < 70.0f - 0.01f || sprite.y > 70.0f + 40.0f * 0.5f ||
+			fabsf( sprite.size - 16.0f ) > 0.01f )
+			misplaced++;
+	}
+	TEST_CHECK( count > 10 );
+	TEST_CHECK( misplaced == 0 );
+	
+	// Moving the parent carries local space particles along, world space ones stay behind
+	// and only the ones spawned since are at the new place
+	parent.setPosition( Vector2fMake( 0.0f, 50.0f ) );
+	for ( int frame = 0; frame < 4; frame++ )
+	{
+		millis += 16;
+		ofStubSetElapsedTimeMillis( millis );
+		node.updateWorld();
+		emitter.update();
+	}
+	
+	int moved = 0;
+	for ( int i = 0; i < emitter.getParticleCount(); i++ )
+	{
+		if ( emitter.getVertices()[i].x < 50.0f )
+			moved++;
+	}
+	if ( space == kParticleSpaceLocal )
+		TEST_CHECK( moved == emitter.getParticleCount() );
+	else
+		TEST_CHECK( moved > 0 && moved < count / 2 );
+	
+	printf( "  %s space: %d particles, %d misplaced, %d following the parent\n",
+		space == kParticleSpaceLocal ? "local" : "world", count, misplaced, moved );
+	
+	emitter.exit();
+}
+
+int main( int argc, char** argv )
+{
+	ofSetLogLevel( OF_LOG_SILENT );
+	
+	testCycles();
+	testVersions();
+	testSpace( kParticleSpaceWorld );
+	testSpace( kParticleSpaceLocal );
+	
+	printf( "  %d failures\n", testFailures );
+	return testFailures > 0;
+}
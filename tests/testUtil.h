@@ -0,0 +1,160 @@
+//
+// testUtil.h
+//
+// Copyright (c) 2010 71Squared, ported to Openframeworks by Shawn Roske
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Helpers shared by the tests and benchmarks in this directory
+
+#ifndef _TEST_UTIL
+#define _TEST_UTIL
+
+#include "ofMain.h"
+#include "ofxParticleEmitter.h"
+
+#include <sys/time.h>
+
+static int testFailures = 0;
+
+#define TEST_CHECK( condition ) \
+	do { if ( !( condition ) ) { testFailures++; fprintf( stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition ); } } while ( 0 )
+
+// Wall clock in seconds for timing
+static inline double testSeconds()
+{
+	timeval now;
+	gettimeofday( &now, NULL );
+	return now.tv_sec + now.tv_usec / 1000000.0;
+}
+
+// Write contents to filename, for the tests that load from disk
+static inline bool testWriteFile( const std::string& filename, const std::string& contents )
+{
+	std::ofstream file( filename.c_str(), std::ios::binary );
+	file << contents;
+	return file.good();
+}
+
+// A .pex config.  extra is placed first so its tags win over the defaults, the stub
+// ofxXmlSettings returns the first element with a matching name
+static inline std::string testConfig( int maxParticles, float lifespan, float lifespanVariance, const std::string& extra = "" )
+{
+	std::ostringstream pex;
+	pex << "<particleEmitterConfig>" << extra
+		<< "<texture name=\"particle.png\"/>"
+		<< "<sourcePosition x=\"160\" y=\"240\"/>"
+		<< "<sourcePositionVariance x=\"7\" y=\"7\"/>"
+		<< "<speed value=\"60\"/><speedVariance value=\"40\"/>"
+		<< "<particleLifespan value=\"" << lifespan << "\"/>"
+		<< "<particleLifespanVariance value=\"" << lifespanVariance << "\"/>"
+		<< "<angle value=\"90\"/><angleVariance value=\"180\"/>"
+		<< "<gravity x=\"0\" y=\"-20\"/>"
+		<< "<radialAcceleration value=\"5\"/><tangentialAcceleration value=\"10\"/>"
+		<< "<radialAccelVariance value=\"1\"/><tangentialAccelVariance value=\"1\"/>"
+		<< "<startColor red=\"1\" green=\"0.5\" blue=\"0.2\" alpha=\"1\"/>"
+		<< "<startColorVariance red=\"0\" green=\"0\" blue=\"0\" alpha=\"0\"/>"
+		<< "<finishColor red=\"0.2\" green=\"0.2\" blue=\"1\" alpha=\"0\"/>"
+		<< "<finishColorVariance red=\"0\" green=\"0\" blue=\"0\" alpha=\"0\"/>"
+		<< "<maxParticles value=\"" << maxParticles << "\"/>"
+		<< "<startParticleSize value=\"24\"/><startParticleSizeVariance value=\"8\"/>"
+		<< "<finishParticleSize value=\"8\"/><FinishParticleSizeVariance value=\"4\"/>"
+		<< "<duration value=\"-1\"/><emitterType value=\"0\"/>"
+		<< "<maxRadius value=\"100\"/><maxRadiusVariance value=\"0\"/><minRadius value=\"0\"/>"
+		<< "<rotatePerSecond value=\"0\"/><rotatePerSecondVariance value=\"0\"/>"
+		<< "<blendFuncSource value=\"770\"/><blendFuncDestination value=\"771\"/>"
+		<< "</particleEmitterConfig>";
+	return pex.str();
+}
+
+// Extra tags that set a random subset of the config to values a broken or hostile file
+// could hold, for use with testConfig()
+static inline std::string testHostileConfig( GLuint& state )
+{
+	static const char* values[] =
+	{
+		"nan", "-nan", "inf", "-inf", "1e38", "-1e38", "3.4e38", "1e-38", "0", "-0", "-1",
+		"1", "0.5", "100", "-100000", "2147483647", "-2147483648", "1e12", "abc", ""
+	};
+	static const char* tags[] =
+	{
+		"sourcePosition x", "sourcePosition y", "sourcePositionVariance x", "sourcePositionVariance y",
+		"speed value", "speedVariance value", "particleLifespan value", "particleLifespanVariance value",
+		"angle value", "angleVariance value", "gravity x", "gravity y",
+		"radialAcceleration value", "tangentialAcceleration value",
+		"radialAccelVariance value", "tangentialAccelVariance value",
+		"startColor red", "startColor alpha", "finishColor green", "finishColorVariance blue",
+		"maxParticles value", "startParticleSize value", "startParticleSizeVariance value",
+		"finishParticleSize value", "FinishParticleSizeVariance value", "duration value",
+		"emitterType value", "maxRadius value", "maxRadiusVariance value", "minRadius value",
+		"rotatePerSecond value", "rotatePerSecondVariance value", "radiusSpeed value",
+		"blendFuncSource value", "blendFuncDestination value", "sortMode value",
+		"simulationSpace value", "emitterShape value", "emitterShapeRadius value",
+		"emitterShapeInnerRadius value", "emitterShapeLineStart x", "emitterShapeLineEnd y",
+		"emitterShapeMask scale", "emitterShapeMask threshold"
+	};
+	int numValues = sizeof( values ) / sizeof( values[0] );
+	int numTags = sizeof( tags ) / sizeof( tags[0] );
+	
+	std::ostringstream extra;
+	int count = 1 + (int)( Xorshift32Random0To1( state ) * 8 );
+	for ( int i = 0; i < count; i++ )
+	{
+		std::string tag = tags[(int)( Xorshift32Random0To1( state ) * numTags ) % numTags];
+		size_t space = tag.find( ' ' );
+		extra << "<" << tag.substr( 0, space ) << " " << tag.substr( space + 1 ) << "=\""
+			  << values[(int)( Xorshift32Random0To1( state ) * numValues ) % numValues] << "\"/>";
+	}
+	
+	// Sometimes a polygon or a mask to go with emitterShape
+	GLfloat shape = Xorshift32Random0To1( state );
+	if ( shape < 0.2f )
+	{
+		for ( int i = 0; i < 3 + (int)( Xorshift32Random0To1( state ) * 4 ); i++ )
+			extra << "<emitterShapePoint x=\"" << values[(int)( Xorshift32Random0To1( state ) * numValues ) % numValues]
+				  << "\" y=\"" << ( i * 37 % 11 ) << "\"/>";
+	}
+	else if ( shape < 0.3f )
+	{
+		extra << "<emitterShapeMask name=\"mask.png\" scale=\"" << values[(int)( Xorshift32Random0To1( state ) * numValues ) % numValues]
+			  << "\" threshold=\"" << values[(int)( Xorshift32Random0To1( state ) * numValues ) % numValues] << "\"/>";
+	}
+	
+	return extra.str();
+}
+
+// True if the emitter's particle count is in range and every sprite is finite
+static inline bool testEmitterIsSane( const ofxParticleEmitter& emitter )
+{
+	int count = emitter.getParticleCount();
+	if ( count < 0 || count > emitter.maxParticles || emitter.maxParticles > MAXIMUM_PARTICLES )
+		return false;
+	
+	const PointSprite* sprites = emitter.getVertices();
+	for ( int i = 0; i < count; i++ )
+	{
+		const PointSprite& s = sprites[i];
+		GLfloat sum = s.x + s.y + s.size + s.color.red + s.color.green + s.color.blue + s.color.alpha;
+		if ( !( sum - sum == 0.0f ) || s.size < 0 )
+			return false;
+	}
+	return true;
+}
+
+#endif